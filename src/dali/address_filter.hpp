@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * Licensed under GNU General Public License 3.0 or later.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef DALI_ADDRESS_FILTER_HPP_
+#define DALI_ADDRESS_FILTER_HPP_
+
+#include "dali.hpp"
+
+namespace dali {
+
+// Tells if a forward frame with the given address byte can concern the device.
+// Bit per address byte without the selector bit: short addresses, groups,
+// special commands and broadcast.
+class AddressFilter {
+public:
+  AddressFilter() {
+    set(DALI_MASK, 0);
+  }
+
+  void set(uint8_t shortAddr, uint16_t groups) {
+    mMatch[0] = 0;
+    mMatch[1] = 0;
+    uint8_t index = shortAddr >> 1;
+    if (index <= DALI_ADDR_MAX) {
+      mMatch[index >> 5] |= 1UL << (index & 0x1f);
+    }
+    // groups 0x80-0x9f, special commands 0xa0-0xfd, broadcast 0xfe-0xff
+    mMatch[2] = 0xffff0000UL | groups;
+    mMatch[3] = 0xffffffffUL;
+  }
+
+  bool match(uint8_t addr) const {
+    uint8_t index = addr >> 1;
+    return (mMatch[index >> 5] & (1UL << (index & 0x1f))) != 0;
+  }
+
+private:
+  uint32_t mMatch[4];
+};
+
+} // namespace dali
+
+#endif // DALI_ADDRESS_FILTER_HPP_
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * Licensed under GNU General Public License 3.0 or later.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef DALI_COMMAND_DESCRIPTOR_HPP_
+#define DALI_COMMAND_DESCRIPTOR_HPP_
+
+#include "dali.hpp"
+
+namespace dali {
+
+// executed only when received twice within 100ms
+const uint8_t kCommandSendTwice = 0x01;
+// query, may answer with a backward frame
+const uint8_t kCommandAnswers = 0x02;
+// disables memory writing enabled by ENABLE_WRITE_MEMORY
+const uint8_t kCommandClearsWriteEnable = 0x04;
+// device type selected by ENABLE_DEVICE_TYPE_X is kept for the next command
+const uint8_t kCommandKeepsDeviceType = 0x08;
+
+template<typename T>
+struct CommandDescriptor {
+  typedef Status (*Handler)(T* slave, uint16_t repeat, Command cmd, uint8_t param);
+
+  Handler handler;
+  uint8_t flags;
+
+  constexpr bool is(uint8_t flag) const {
+    return (flags & flag) != 0;
+  }
+};
+
+template<uint16_t... kIndexes>
+struct CommandIndexes {
+};
+
+template<uint16_t kCount, uint16_t... kIndexes>
+struct MakeCommandIndexes: MakeCommandIndexes<kCount - 1, kCount - 1, kIndexes...> {
+};
+
+template<uint16_t... kIndexes>
+struct MakeCommandIndexes<0, kIndexes...> {
+  typedef CommandIndexes<kIndexes...> Type;
+};
+
+// Run time copy of a constexpr descriptors table. Handlers and flags are kept
+// in separate arrays, so the flags do not take a padded word each.
+template<typename T, const CommandDescriptor<T>* kDescriptors, typename Indexes>
+class CommandTable;
+
+template<typename T, const CommandDescriptor<T>* kDescriptors, uint16_t... kIndexes>
+class CommandTable<T, kDescriptors, CommandIndexes<kIndexes...>> {
+public:
+  static CommandDescriptor<T> get(uint16_t index) {
+    return CommandDescriptor<T> { kHandlers[index], kFlags[index] };
+  }
+
+private:
+  static constexpr typename CommandDescriptor<T>::Handler kHandlers[sizeof...(kIndexes)] = {
+      kDescriptors[kIndexes].handler... };
+  static constexpr uint8_t kFlags[sizeof...(kIndexes)] = { kDescriptors[kIndexes].flags... };
+};
+
+template<typename T, const CommandDescriptor<T>* kDescriptors, uint16_t... kIndexes>
+constexpr typename CommandDescriptor<T>::Handler
+CommandTable<T, kDescriptors, CommandIndexes<kIndexes...>>::kHandlers[sizeof...(kIndexes)];
+
+template<typename T, const CommandDescriptor<T>* kDescriptors, uint16_t... kIndexes>
+constexpr uint8_t CommandTable<T, kDescriptors, CommandIndexes<kIndexes...>>::kFlags[sizeof...(kIndexes)];
+
+} // namespace dali
+
+#endif // DALI_COMMAND_DESCRIPTOR_HPP_
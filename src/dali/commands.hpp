@@ -186,6 +186,7 @@ enum class Command {
   DATA_TRANSFER_REGISTER_1 = _SPECIAL_COMMAND + 195, // 273
   DATA_TRANSFER_REGISTER_2 = _SPECIAL_COMMAND + 197, // 274
   WRITE_MEMORY_LOCATION = _SPECIAL_COMMAND + 199, // 275
+  WRITE_MEMORY_LOCATION_NO_REPLY = _SPECIAL_COMMAND + 201, // DALI-2
 
   INVALID = 0xffff,
 };
@@ -16,17 +16,18 @@ namespace dali {
 namespace controller {
 namespace {
 
-const Time kCommandRepeatTimeout = 100;
+const Time kCommandRepeatTimeout = 100000; // us
 
 }
 
-Bus::Bus(IBusDriver* bus, Client* client) :
+Bus::Bus(BusDriver* bus, Client* client) :
     mBus(bus),
     mClient(client),
     mState(IBusDriver::IBusState::UNKNOWN),
     mLastCommand(Command::INVALID),
     mCommandRepeatCount(0),
     mLastCommandTime(0) {
+  setAddress(DALI_MASK, 0);
   mBus->registerClient(this);
 }
 
@@ -53,7 +54,7 @@ void Bus::onDataReceived(Time time, uint16_t data) {
       return;
     }
   } else if (mLastCommand == command) {
-    if (time - mLastCommandTime < kCommandRepeatTimeout) {
+    if (timeDiff(time, mLastCommandTime) < kCommandRepeatTimeout) {
       mCommandRepeatCount++;
     } else {
       mLastCommand = Command::INVALID;
@@ -72,7 +73,7 @@ void Bus::onDataReceived(Time time, uint16_t data) {
     mLastCommand = Command::INVALID;
     mCommandRepeatCount = 0;
     mLastCommandTime = time;
-    if (time - mLastCommandTime < kCommandRepeatTimeout) {
+    if (timeDiff(time, mLastCommandTime) < kCommandRepeatTimeout) {
       mClient->handleIgnoredCommand(command, param);
     } else {
       Status status = mClient->handleCommand(mCommandRepeatCount, command, param);
@@ -86,6 +87,12 @@ void Bus::onDataReceived(Time time, uint16_t data) {
   }
 }
 
+void Bus::setAddress(uint8_t shortAddr, uint16_t groups) {
+  mShortAddr = shortAddr;
+  mAddressFilter.set(shortAddr, groups);
+  mBus->setAddressFilter(mAddressFilter);
+}
+
 void Bus::onBusStateChanged(IBusDriver::IBusState state) {
   if (mState != state) {
     mState = state;
@@ -99,45 +106,21 @@ Command Bus::extractCommand(uint16_t data, uint8_t* commandParam) {
   Command command = Command::INVALID;
   uint8_t param = (uint8_t) (data & 0xff);
   uint8_t addr = (uint8_t) (data >> 8);
-  bool cmdBitSet = ((addr & 0x01) != 0);
-  if ((addr & 0xfe) == 0xfe) {
-    // Broadcast
-    if (cmdBitSet) {
-      command = (Command) param;
-      param = 0xff;
-    } else {
-      command = Command::DIRECT_POWER_CONTROL;
-    }
-  } else if ((addr & 0x80) == 0) {
-    // Short address
-    addr >>= 1;
-    uint8_t myAddr = mClient->getShortAddr() >> 1;
-    if (cmdBitSet) {
-      command = (Command) param;
-      param = 0xff;
-    } else {
-      command = Command::DIRECT_POWER_CONTROL;
-    }
-    if (addr != myAddr) {
-      return Command::INVALID;
-    }
-  } else if ((addr & 0x60) == 0) {
-    // Group address
-    uint8_t group = (addr >> 1) & 0x0f;
-    uint16_t groups = mClient->getGroups();
-    if (cmdBitSet) {
+  if (!mAddressFilter.match(addr)) {
+    return Command::INVALID;
+  }
+  if (((addr & 0xfe) == 0xfe) || ((addr & 0x80) == 0) || ((addr & 0x60) == 0)) {
+    // Broadcast, short or group address
+    if ((addr & 0x01) != 0) {
       command = (Command) param;
       param = 0xff;
     } else {
       command = Command::DIRECT_POWER_CONTROL;
     }
-    if ((groups & (1 << group)) == 0) {
-      return Command::INVALID;
-    }
   } else {
     command = (Command) ((uint16_t) Command::_SPECIAL_COMMAND + addr);
     if (command == Command::INITIALISE) {
-      uint8_t myAddr = mClient->getShortAddr() >> 1;
+      uint8_t myAddr = mShortAddr >> 1;
       switch (param) {
       case 0x00: // All control gear shall react
         break;
@@ -11,7 +11,9 @@
 #ifndef DALI_BUS_CONTROLLER_H_
 #define DALI_BUS_CONTROLLER_H_
 
+#include <dali/address_filter.hpp>
 #include <dali/dali.hpp>
+#include <dali/drivers.hpp>
 
 namespace dali {
 namespace controller {
@@ -21,19 +23,20 @@ public:
 
   class Client {
   public:
-    virtual uint8_t getShortAddr() = 0;
-    virtual uint16_t getGroups() = 0;
     virtual Status handleCommand(uint16_t repeat, Command cmd, uint8_t param) = 0;
     virtual Status handleIgnoredCommand(Command cmd, uint8_t param) = 0;
     virtual void onBusDisconnected() = 0;
   };
 
-  explicit Bus(IBusDriver* bus, Client* client);
+  explicit Bus(BusDriver* bus, Client* client);
   virtual ~Bus();
 
   Status sendAck(uint8_t ack) { return mBus->sendAck(ack); }
   Time getLastCommandTime() { return mLastCommandTime; }
 
+  // shall be called after every change of the short address or groups
+  void setAddress(uint8_t shortAddr, uint16_t groups);
+
   void onDataReceived(Time time, uint16_t data) override;
   void onBusStateChanged(IBusDriver::IBusState state) override;
 
@@ -43,12 +46,14 @@ private:
 
   Command extractCommand(uint16_t data, uint8_t* param);
 
-  IBusDriver* const mBus;
+  BusDriver* const mBus;
   Client* mClient;
   IBusDriver::IBusState mState;
   Command mLastCommand;
   uint16_t mCommandRepeatCount;
   Time mLastCommandTime;
+  uint8_t mShortAddr;
+  AddressFilter mAddressFilter;
 };
 
 } // namespace controller
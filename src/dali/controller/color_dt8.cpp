@@ -262,14 +262,17 @@ uint16_t findValidPrimaries(const Primary primary[], uint16_t nrOfPrimaries, Poi
 
 // static
 bool ColorDT8::xyToPrimary(PointXY xy, const Primary primary[], uint16_t nrOfPrimaries, Float level[]) {
-  PointXY primaryXY[nrOfPrimaries];
-  uint16_t primaryNr[nrOfPrimaries];
+  if (nrOfPrimaries > DALI_DT8_NUMBER_OF_PRIMARIES) {
+    nrOfPrimaries = DALI_DT8_NUMBER_OF_PRIMARIES;
+  }
+  PointXY primaryXY[DALI_DT8_NUMBER_OF_PRIMARIES];
+  uint16_t primaryNr[DALI_DT8_NUMBER_OF_PRIMARIES];
   uint16_t n = findValidPrimaries(primary, nrOfPrimaries, primaryXY, primaryNr);
 
   memset(level, 0, sizeof(uint16_t) * nrOfPrimaries);
 
   bool limitError = false;
-  Float out[n];
+  Float out[3]; // at most 3 primaries are mixed
   switch (n) {
   case 0:
     // no calibrated primary found
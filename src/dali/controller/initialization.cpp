@@ -16,7 +16,7 @@
 namespace dali {
 namespace controller {
 
-Initialization::Initialization(ITimer* timer, Memory* memoryController) :
+Initialization::Initialization(TimerDriver* timer, Memory* memoryController) :
     mTimer(timer),
     mMemoryController(memoryController),
     mInitializeTime(0),
@@ -267,7 +267,7 @@ void Initialization::operatingTimeStop() {
 }
 
 void Initialization::checkOperatingTimeout() {
-  if ((mInitializeTime != 0) && (mTimer->getTime() > mInitializeTime)) {
+  if ((mInitializeTime != 0) && isTimeBefore(mInitializeTime, mTimer->getTime())) {
     terminate();
   }
 }
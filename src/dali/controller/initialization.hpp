@@ -12,6 +12,7 @@
 #define DALI_CONFIGURATION_CONTROLER_H_
 
 #include <dali/dali.hpp>
+#include <dali/drivers.hpp>
 
 namespace dali {
 namespace controller {
@@ -21,7 +22,7 @@ class Bus;
 
 class Initialization {
 public:
-  explicit Initialization(ITimer* timer, Memory* memoryController);
+  explicit Initialization(TimerDriver* timer, Memory* memoryController);
   virtual ~Initialization() {}
 
   Status initialize(uint8_t param);
@@ -54,7 +55,7 @@ private:
   void operatingTimeStop();
   void checkOperatingTimeout();
 
-  ITimer* const mTimer;
+  TimerDriver* const mTimer;
   Memory* const mMemoryController;
   Time mInitializeTime;
   bool mInitialized;
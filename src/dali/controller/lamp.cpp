@@ -13,11 +13,12 @@
 #include "lamp_helper.hpp"
 
 #define DAPC_TIME_MS 200
+#define DAPC_TIME_US (DAPC_TIME_MS * 1000)
 
 namespace dali {
 namespace controller {
 
-Lamp::Lamp(ILamp* lamp, Memory* memoryController)
+Lamp::Lamp(LampDriver* lamp, Memory* memoryController)
     : mLamp(lamp)
     , mMemoryController(memoryController)
     , mMode(Mode::NORMAL)
@@ -104,7 +105,7 @@ Status Lamp::powerDirect(uint8_t level, Time time) {
     mLamp->abortFading();
     return Status::OK;
   }
-  if (time - mDapcTime <= DAPC_TIME_MS) {
+  if (timeDiff(time, mDapcTime) <= DAPC_TIME_US) {
     return dapcSequence(level, time);
   }
   onPowerCommand();
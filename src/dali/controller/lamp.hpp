@@ -12,6 +12,7 @@
 #define DALI_LAMP_CONTROLLER_HPP_
 
 #include <dali/dali.hpp>
+#include <dali/drivers.hpp>
 
 #include "memory.hpp"
 
@@ -26,7 +27,7 @@ public:
     virtual void onLampStateChnaged(ILamp::ILampState state) = 0;
   };
 
-  explicit Lamp(ILamp* lamp, Memory* memoryController);
+  explicit Lamp(LampDriver* lamp, Memory* memoryController);
   virtual ~Lamp();
 
 // >>> used only in controller namespace
@@ -66,7 +67,7 @@ public:
   Status enableDapcSequence(Time time);
 
 protected:
-  ILamp* const getLamp() { return mLamp; }
+  LampDriver* const getLamp() { return mLamp; }
   Memory* const getMemoryController() { return mMemoryController; }
 
   enum class Mode {
@@ -87,7 +88,7 @@ private:
   // ILamp::ILampClient
   void onLampStateChnaged(ILamp::ILampState state) override;
 
-  ILamp* const mLamp;
+  LampDriver* const mLamp;
   Memory* const mMemoryController;
   Mode mMode;
   ILamp::ILampState mLampState;
@@ -18,7 +18,7 @@
 namespace dali {
 namespace controller {
 
-LampDT8::LampDT8(ILamp* lamp, MemoryDT8* memoryController) :
+LampDT8::LampDT8(LampDriver* lamp, MemoryDT8* memoryController) :
     Lamp(lamp, memoryController), mXYCoordinateLimitError(false), mTemeratureLimitError(false) {
   for (uint16_t i = 0; i < DALI_DT8_NUMBER_OF_PRIMARIES; ++i) {
     mActualPrimary[i] = 0;
@@ -51,7 +51,7 @@ bool LampDT8::isTemeratureLimitError() {
   return mTemeratureLimitError;
 }
 
-Status LampDT8::powerDirect(uint8_t level, uint64_t time) {
+Status LampDT8::powerDirect(uint8_t level, Time time) {
   if (isAutomaticActivationEnabled()) {
     activateColor(getFadeTime());
   } else if (level == DALI_MASK) {
@@ -27,7 +27,7 @@ namespace controller {
 class LampDT8: public Lamp {
 public:
 
-  explicit LampDT8(ILamp* lamp, MemoryDT8* memoryController);
+  explicit LampDT8(LampDriver* lamp, MemoryDT8* memoryController);
 
 // >>> used only in controller namespace
 
@@ -39,7 +39,7 @@ public:
   bool isTemeratureLimitError();
 // <<< used only in controller namespace
 
-  Status powerDirect(uint8_t level, uint64_t time) override;
+  Status powerDirect(uint8_t level, Time time) override;
   Status powerOff() override;
   Status powerScene(uint8_t scene) override;
   Status powerUp() override;
@@ -71,8 +71,8 @@ private:
   LampDT8(const LampDT8& other) = delete;
   LampDT8& operator=(const LampDT8&) = delete;
 
-  ILampDT8* getLampDT8() {
-    return (ILampDT8*) getLamp();
+  LampDT8Driver* getLampDT8() {
+    return (LampDT8Driver*) getLamp();
   }
 
   MemoryDT8* getMemoryDT8() {
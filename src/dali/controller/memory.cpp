@@ -17,15 +17,49 @@
 
 #define LONG_ADDR_MASK 0x00ffffff
 
-#define INVALID_BANK_ADDR 0xffffffff
-
 namespace dali {
 namespace controller {
 
-Memory::Memory(IMemory* memory) :
+namespace {
+
+typedef struct {
+  uint16_t addr;
+  uint8_t size;
+  bool readOnly;
+} BankDescriptor;
+
+constexpr BankDescriptor kBanks[DALI_BANKS] = {
+    { DALI_BANK0_ADDR, DALI_BANK1_ADDR - DALI_BANK0_ADDR, true },
+    { DALI_BANK1_ADDR, DALI_BANK2_ADDR - DALI_BANK1_ADDR, false },
+    { DALI_BANK2_ADDR, DALI_BANK3_ADDR - DALI_BANK2_ADDR, false },
+    { DALI_BANK3_ADDR, DALI_BANK4_ADDR - DALI_BANK3_ADDR, false },
+    { DALI_BANK4_ADDR, DALI_BANK5_ADDR - DALI_BANK4_ADDR, false },
+    { DALI_BANK5_ADDR, DALI_BANK6_ADDR - DALI_BANK5_ADDR, true }, // provided by the memory driver
+};
+
+const uint8_t kBankLockAddr = 2;
+const uint8_t kBankUnlocked = 0x55;
+
+// banks follow each other, each one has the size, crc and lock byte
+constexpr bool checkBanks(uint8_t i) {
+  return i == DALI_BANKS ? true :
+      kBanks[i].size > kBankLockAddr
+      && (i == 0 || kBanks[i].addr == kBanks[i - 1].addr + kBanks[i - 1].size)
+      && checkBanks(i + 1);
+}
+
+static_assert(checkBanks(0), "invalid banks table");
+static_assert(kBanks[DALI_BANKS - 1].addr + kBanks[DALI_BANKS - 1].size == DALI_BANK6_ADDR, "invalid banks table");
+
+} // namespace
+
+Memory::Memory(MemoryDriver* memory) :
     mMemory(memory),
     mData((Data*) memory->data(DALI_BANK2_ADDR, sizeof(Data))),
-    mTemp((Temp*) memory->tempData(0, sizeof(Temp)))
+    mTemp((Temp*) memory->tempData(0, sizeof(Temp))),
+    mListener(nullptr),
+    mWriteNesting(0),
+    mBankCrcPending(0)
 {
   resetRam(true);
 
@@ -50,31 +84,40 @@ Memory::Memory(IMemory* memory) :
 }
 
 Status Memory::readMemory(uint8_t* data) {
-  uint8_t bank = mRam.dtr1;
-  uint8_t addr = mRam.dtr;
-
-  Status status = Status::OK;
-  if (bankRead(bank, addr++, data) != Status::OK) {
-    status = Status::ERROR;
-  }
-  if (bankRead(bank, addr, &mRam.dtr2) != Status::OK) {
-    // ignore status
+  const uint8_t bank = mRam.dtr1;
+  const uint8_t addr = mRam.dtr;
+  if ((bank >= DALI_BANKS) || (addr >= kBanks[bank].size) || (mBankData[bank] == nullptr)) {
+    return Status::ERROR;
   }
-  if (status == Status::OK) {
-    mRam.dtr++;
+  const uint8_t* bankData = mBankData[bank];
+  *data = bankData[addr];
+  if (addr + 1 < kBanks[bank].size) {
+    mRam.dtr2 = bankData[addr + 1]; // next location
   }
-  return status;
+  mRam.dtr++;
+  return Status::OK;
 }
 
 Status Memory::writeMemory(uint8_t data) {
-  uint8_t bank = mRam.dtr1;
-  uint8_t addr = mRam.dtr;
-
-  Status status = bankWrite(bank, addr, data, false);
-  if (status == Status::OK) {
-    mRam.dtr++;
+  const uint8_t bank = mRam.dtr1;
+  const uint8_t addr = mRam.dtr;
+  if ((bank >= DALI_BANKS) || (addr >= kBanks[bank].size)) {
+    return Status::ERROR;
   }
-  return status;
+  if (!isBankAddrWritable(bank, addr)) {
+    return Status::INVALID;
+  }
+  // an unchanged location keeps the checksum, nothing is stored
+  if ((mBankData[bank][addr] != data) && (internalBankWrite(bank, addr, &data, sizeof(uint8_t)) != Status::OK)) {
+    return Status::ERROR;
+  }
+  // bank 2 holds the data, the address can be changed there as well
+  if ((bank == 2) && (addr >= DATA_FIELD_OFFSET(Data, shortAddr))
+      && (addr < DATA_FIELD_OFFSET(Data, groups) + sizeof(uint16_t))) {
+    onAddressChanged();
+  }
+  mRam.dtr++;
+  return Status::OK;
 }
 
 Status Memory::setPhisicalMinLevel(uint8_t level) {
@@ -83,7 +126,9 @@ Status Memory::setPhisicalMinLevel(uint8_t level) {
 
 Status Memory::setShortAddr(uint8_t addr) {
   addr |= 0x01; // normalize address
-  return writeData8(DATA_FIELD_OFFSET(Data, shortAddr), addr);
+  Status status = writeData8(DATA_FIELD_OFFSET(Data, shortAddr), addr);
+  onAddressChanged();
+  return status;
 }
 
 Status Memory::setMinLevel(uint8_t level) {
@@ -125,7 +170,9 @@ Status Memory::setLevelForScene(uint8_t scene, uint8_t level) {
 }
 
 Status Memory::setGroups(uint16_t groups) {
-  return writeData16(DATA_FIELD_OFFSET(Data, groups), groups);
+  Status status = writeData16(DATA_FIELD_OFFSET(Data, groups), groups);
+  onAddressChanged();
+  return status;
 }
 
 Status Memory::setSearchAddr(uint32_t searchAddr) {
@@ -190,10 +237,11 @@ bool Memory::isReset() {
 }
 
 Status Memory::reset() {
+  beginWrite();
   resetRam(false);
   resetData(false);
   resetTemp();
-  return Status::OK;
+  return commitWrite();
 }
 
 void Memory::resetRam(bool initialize) {
@@ -206,6 +254,7 @@ void Memory::resetRam(bool initialize) {
 }
 
 void Memory::resetData(bool initialize) {
+  beginWrite();
   if (initialize) {
     setPhisicalMinLevel(DALI_PHISICAL_MIN_LEVEL);
   }
@@ -219,9 +268,10 @@ void Memory::resetData(bool initialize) {
     setShortAddr(DALI_MASK);
   }
   setGroups(0);
-  for (size_t i = 0; i < 16; i++) {
-    setLevelForScene(i, DALI_MASK);
-  }
+  uint8_t scenes[DALI_SCENE_MAX + 1];
+  memset(scenes, DALI_MASK, sizeof(scenes));
+  writeData(DATA_FIELD_OFFSET(Data, scene), scenes, sizeof(scenes));
+  commitWrite();
 }
 
 void Memory::resetTemp() {
@@ -229,23 +279,40 @@ void Memory::resetTemp() {
   setActualLevel(DALI_MASK);
 }
 
-Status Memory::internalBankWrite(uint8_t bank, uint8_t addr, uint8_t* data, uint8_t size) {
+Status Memory::commitWrite() {
+  if (--mWriteNesting != 0) {
+    return Status::OK;
+  }
   Status status = Status::OK;
-  const uint8_t* bankData = mBankData[bank];
-  uint8_t crc = bankData[1];
-
-  const uintptr_t bankAddr = getBankAddr(bank);
-  const uint16_t endAddr = (uint16_t)addr + size;
-  for (; addr < endAddr; ++addr, ++data) {
-    crc += bankData[addr];
-    crc -= *data;
-
-    if (mMemory->dataWrite(bankAddr + addr, data, 1) != 1) {
+  for (uint8_t bank = 0; mBankCrcPending != 0; ++bank, mBankCrcPending >>= 1) {
+    if ((mBankCrcPending & 1) == 0) {
+      continue;
+    }
+    if (mMemory->dataWrite(getBankAddr(bank) + 1, &mBankCrc[bank], 1) != 1) {
       status = Status::ERROR;
     }
   }
+  return status;
+}
 
-  if (mMemory->dataWrite(bankAddr + 1, &crc, 1) != 1) {
+Status Memory::internalBankWrite(uint8_t bank, uint8_t addr, const uint8_t* data, uint8_t size) {
+  Status status = Status::OK;
+  const uint8_t* bankData = mBankData[bank];
+  const uint8_t bankMask = 1 << bank;
+  uint8_t crc = (mBankCrcPending & bankMask) ? mBankCrc[bank] : bankData[1];
+
+  for (uint8_t i = 0; i < size; ++i) {
+    crc += bankData[addr + i];
+    crc -= data[i];
+  }
+  if (mMemory->dataWrite(getBankAddr(bank) + addr, data, size) != size) {
+    status = Status::ERROR;
+  }
+
+  if (mWriteNesting != 0) {
+    mBankCrc[bank] = crc;
+    mBankCrcPending |= bankMask;
+  } else if (mMemory->dataWrite(getBankAddr(bank) + 1, &crc, 1) != 1) {
     status = Status::ERROR;
   }
 
@@ -253,88 +320,26 @@ Status Memory::internalBankWrite(uint8_t bank, uint8_t addr, uint8_t* data, uint
 }
 
 size_t Memory::getBankSize(uint8_t bank) {
-  switch (bank) {
-  case 0:
-    return DALI_BANK1_ADDR - DALI_BANK0_ADDR;
-  case 1:
-    return DALI_BANK2_ADDR - DALI_BANK1_ADDR;
-  case 2:
-    return DALI_BANK3_ADDR - DALI_BANK2_ADDR;
-  case 3:
-    return DALI_BANK4_ADDR - DALI_BANK3_ADDR;
-  case 4:
-    return DALI_BANK5_ADDR - DALI_BANK4_ADDR;
-  default:
-    return 0;
-  }
+  return bank < DALI_BANKS ? kBanks[bank].size : 0;
 }
 
 uintptr_t Memory::getBankAddr(uint8_t bank) {
-  switch (bank) {
-  case 0: // read only
-    return DALI_BANK0_ADDR;
-  case 1:
-    return DALI_BANK1_ADDR;
-  case 2:
-    return DALI_BANK2_ADDR;
-  case 3:
-    return DALI_BANK3_ADDR;
-  case 4:
-    return DALI_BANK4_ADDR;
-  default:
-    return INVALID_BANK_ADDR;
-  }
-}
-
-Status Memory::bankWrite(uint8_t bank, uint8_t addr, uint8_t data, bool force) {
-  uint8_t size = getBankSize(bank);
-  if (size < 3 && addr > size) {
-    return Status::ERROR;
-  }
-  if (!force && !isBankAddrWritable(bank, addr)) {
-    return Status::INVALID;
-  }
-  return internalBankWrite(bank, addr, &data, sizeof(uint8_t));
+  return kBanks[bank].addr;
 }
 
 Status Memory::bankRead(uint8_t bank, uint8_t addr, uint8_t* data) {
-  uint8_t size = getBankSize(bank);
-  if (addr + 1 > size) {
+  if ((bank >= DALI_BANKS) || (addr >= kBanks[bank].size) || (mBankData[bank] == nullptr)) {
     return Status::ERROR;
   }
-  uintptr_t bankAddr = getBankAddr(bank);
-  if (bankAddr == INVALID_BANK_ADDR) {
-    return Status::ERROR;
-  }
-  const uint8_t* bankData = mMemory->data(bankAddr + addr, 1);
-  if (bankData == nullptr) {
-    return dali::Status::ERROR;
-  }
-  *data = *bankData;
+  *data = mBankData[bank][addr];
   return Status::OK;
 }
 
 bool Memory::isBankAddrWritable(uint8_t bank, uint8_t addr) {
-  if (bank == 0) {
-    // read only
+  if ((bank >= DALI_BANKS) || kBanks[bank].readOnly || (mBankData[bank] == nullptr) || (addr < kBankLockAddr)) {
     return false;
   }
-
-  uintptr_t bankAddr = getBankAddr(bank);
-  if (bankAddr != INVALID_BANK_ADDR) {
-    if (addr < 2) {
-      return false;
-    }
-    if (addr == 2) {
-      return true;
-    }
-    const uint8_t* bankData = mMemory->data(bankAddr + 2, 1);
-    if ((bankData == nullptr) || (*bankData != 0x55)) {
-      return false;
-    }
-    return true;
-  }
-  return false;
+  return (addr == kBankLockAddr) || (mBankData[bank][kBankLockAddr] == kBankUnlocked);
 }
 
 void Memory::resetBankIfNeeded(uint8_t bank) {
@@ -363,9 +368,11 @@ void Memory::resetBankIfNeeded(uint8_t bank) {
     mMemory->dataWrite(bankAddr, &temp, 1);
     temp = 0 - (0xff * (bankSize - 2)); // crc
     mMemory->dataWrite(bankAddr + 1, &temp, 1);
-    temp = 0xff; // reset data
-    for (uint8_t i = 2; i < bankSize; ++i) {
-      mMemory->dataWrite(bankAddr + i, &temp, 1);
+    uint8_t erased[16]; // reset data
+    memset(erased, 0xff, sizeof(erased));
+    for (uint8_t i = 2; i < bankSize; i += sizeof(erased)) {
+      size_t size = bankSize - i < sizeof(erased) ? bankSize - i : sizeof(erased);
+      mMemory->dataWrite(bankAddr + i, erased, size);
     }
 
     if (bank == 0) {
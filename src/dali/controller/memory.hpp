@@ -12,15 +12,30 @@
 #define DALI_MEMORY_CONTROLLER_HPP_
 
 #include <dali/dali.hpp>
+#include <dali/drivers.hpp>
 
 namespace dali {
 namespace controller {
 
 class Memory {
 public:
-  explicit Memory(IMemory* memory);
+
+  class Listener {
+  public:
+    virtual void onAddressChanged() = 0;
+  };
+
+  // volatile fields only, the drivers may save them in a short emergency record
+  typedef struct __attribute__((__packed__)) {
+    uint32_t randomAddr;
+    uint8_t actualLevel;
+  } Temp;
+
+  explicit Memory(MemoryDriver* memory);
   virtual ~Memory() {};
 
+  void setListener(Listener* listener) { mListener = listener; }
+
   uint8_t getDTR() { return mRam.dtr; }
   void setDTR(uint8_t value) { mRam.dtr = value; }
   uint8_t getDTR1() { return mRam.dtr1; }
@@ -79,15 +94,12 @@ public:
 
 protected:
 
-  typedef struct __attribute__((__packed__)) {
-    uint32_t randomAddr;
-    uint8_t actualLevel;
-    uint8_t reversed1;
-    uint8_t reversed2;
-    uint8_t reversed3;
-  } Temp;
+  // Writes between beginWrite() and commitWrite() keep the bank checksums in RAM,
+  // each touched bank checksum is stored once on the outermost commit.
+  void beginWrite() { mWriteNesting++; }
+  Status commitWrite();
 
-  Status internalBankWrite(uint8_t bank, uint8_t addr, uint8_t* data, uint8_t size);
+  Status internalBankWrite(uint8_t bank, uint8_t addr, const uint8_t* data, uint8_t size);
 
   Status writeTemp(uintptr_t addr, uint8_t* data, size_t size) {
     return mMemory->tempWrite(addr, data, size) == size ? Status::OK : Status::ERROR;
@@ -117,7 +129,7 @@ protected:
     return internalBankWrite(2, addr, (uint8_t*)&data, sizeof(uint16_t));
   }
 
-  Status writeData(uintptr_t addr, uint8_t* data, size_t size) {
+  Status writeData(uintptr_t addr, const uint8_t* data, size_t size) {
     return internalBankWrite(2, addr, data, size);
   }
 
@@ -140,6 +152,8 @@ private:
     uint8_t scene[16];
   } Data;
 
+  static_assert(sizeof(Data) <= DALI_BANK3_ADDR - DALI_BANK2_ADDR, "Data exceeds bank 2");
+
   typedef struct {
     uint8_t dtr;
     uint8_t dtr1;
@@ -147,7 +161,6 @@ private:
     uint32_t searchAddr;
   } Ram;
 
-  Status bankWrite(uint8_t bank, uint8_t addr, uint8_t data, bool force);
   Status bankRead(uint8_t bank, uint8_t addr, uint8_t* data);
 
 
@@ -161,12 +174,21 @@ private:
   uintptr_t getBankAddr(uint8_t bank);
   bool isBankAddrWritable(uint8_t bank, uint8_t addr);
   void resetBankIfNeeded(uint8_t bank);
+  void onAddressChanged() {
+    if (mListener != nullptr) {
+      mListener->onAddressChanged();
+    }
+  }
 
-  IMemory* const mMemory;
+  MemoryDriver* const mMemory;
   Ram mRam;
   const uint8_t* mBankData[DALI_BANKS];
   const Data* mData;
   const Temp* mTemp;
+  Listener* mListener;
+  uint8_t mWriteNesting;
+  uint8_t mBankCrcPending; // bit per bank
+  uint8_t mBankCrc[DALI_BANKS];
 };
 
 } // namespace controller
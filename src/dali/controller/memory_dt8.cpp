@@ -20,7 +20,7 @@
 namespace dali {
 namespace controller {
 
-MemoryDT8::MemoryDT8(IMemory* memory, const DefaultsDT8* defaults) :
+MemoryDT8::MemoryDT8(MemoryDriver* memory, const DefaultsDT8* defaults) :
     Memory(memory),
     mDefaults(defaults),
     mConfigDT8((ConfigDT8*)memory->data(DALI_BANK3_ADDR, sizeof(ConfigDT8))),
@@ -216,10 +216,12 @@ bool MemoryDT8::isReset() {
 }
 
 Status MemoryDT8::reset() {
+  beginWrite();
   resetDataDT8(false);
   resetTempDT8(false);
   resetRamDT8(false);
-  return Memory::reset();
+  Memory::reset();
+  return commitWrite();
 }
 
 #if defined(DALI_DT8_SUPPORT_XY) || defined(DALI_DT8_SUPPORT_PRIMARY_N)
@@ -519,6 +521,7 @@ void MemoryDT8::resetRamDT8(bool initialize) {
 }
 
 void MemoryDT8::resetConfigDT8() {
+  beginWrite();
   writeConfig8(DATA_FIELD_OFFSET(ConfigDT8, version), CONFIG_VERSION);
 
 #ifdef DALI_DT8_SUPPORT_TC
@@ -531,9 +534,11 @@ void MemoryDT8::resetConfigDT8() {
     storePrimaryTy(i, primary.ty);
     storePrimaryCoordinate(i, primary.xy.x, primary.xy.y);
   }
+  commitWrite();
 }
 
 void MemoryDT8::resetDataDT8(bool initialize) {
+  beginWrite();
   ColorDT8 temp;
   temp.setType(mDefaults->colorType);
 
@@ -594,7 +599,7 @@ void MemoryDT8::resetDataDT8(bool initialize) {
   setColorTemperatureCoolest(getColorTemperaturePhisicalCoolest());
   setColorTemperatureWarmest(getColorTemperaturePhisicalWarmest());
 #endif //DALI_DT8_SUPPORT_TC
-
+  commitWrite();
 }
 
 void MemoryDT8::resetTempDT8(bool initialize) {
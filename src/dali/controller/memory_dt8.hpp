@@ -23,7 +23,12 @@ namespace controller {
 
 class MemoryDT8: public Memory {
 public:
-  explicit MemoryDT8(IMemory* memory, const DefaultsDT8* defaults);
+  // volatile fields following Temp in the temp area
+  typedef struct {
+    ColorDT8 actualColor;
+  } TempDT8;
+
+  explicit MemoryDT8(MemoryDriver* memory, const DefaultsDT8* defaults);
 
   Status setPowerOnColor(const ColorDT8& color);
   const ColorDT8& getPowerOnColor();
@@ -143,6 +148,8 @@ private:
     Primary primary[6];
   } ConfigDT8;
 
+  static_assert(sizeof(ConfigDT8) <= DALI_BANK4_ADDR - DALI_BANK3_ADDR, "ConfigDT8 exceeds bank 3");
+
   typedef struct __attribute__((__packed__)) {
     uint8_t size; // BANK mandatory field
     uint8_t crc;  // BANK mandatory field
@@ -157,9 +164,7 @@ private:
 
   } DataDT8;
 
-  typedef struct {
-    ColorDT8 actualColor;
-  } TempDT8;
+  static_assert(sizeof(DataDT8) <= DALI_BANK5_ADDR - DALI_BANK4_ADDR, "DataDT8 exceeds bank 4");
 
   typedef struct {
     ColorDT8 temporaryColor;
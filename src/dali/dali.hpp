@@ -14,6 +14,8 @@
 #include "config.hpp"
 #include "commands.hpp"
 
+#include <util/deadline_queue.hpp>
+
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -39,8 +41,19 @@
 
 namespace dali {
 
-typedef uint64_t Time;
-const Time kTimeInvalid = 0xffffffffffffffffUL;
+// Free running tick counter, wraps around (milliseconds after 49 days,
+// microseconds after 71 minutes). Compare times only by their difference.
+typedef uint32_t Time;
+const Time kTimeInvalid = 0xffffffff;
+
+// time elapsed since the given time, valid for intervals below 2^31 ticks
+inline uint32_t timeDiff(Time now, Time since) {
+  return now - since;
+}
+
+inline bool isTimeBefore(Time a, Time b) {
+  return (int32_t) (a - b) < 0;
+}
 
 enum class Status {
   OK, ERROR, INVALID, INVALID_STATE, REPEAT_REQUIRED
@@ -76,6 +89,8 @@ public:
   virtual void abortFading() = 0;
 };
 
+class AddressFilter;
+
 class IBusDriver {
 public:
   enum class IBusState {
@@ -84,18 +99,22 @@ public:
 
   class IBusClient {
   public:
+    // time - end of the received frame in microseconds
     virtual void onDataReceived(Time time, uint16_t data) = 0;
-    virtual void onBusStateChanged(IBusState state);
+    virtual void onBusStateChanged(IBusState state) = 0;
   };
 
   virtual Status registerClient(IBusClient* c) = 0;
   virtual Status unregisterClient(IBusClient* c) = 0;
   virtual Status sendAck(uint8_t ack) = 0;
+  // frames not matching the filter may be dropped before reaching clients
+  virtual Status setAddressFilter(const AddressFilter& filter) = 0;
 };
 
 class ITimer {
 public:
-  class ITimerTask {
+  // queued by the timer itself, no storage is needed for the scheduled tasks
+  class ITimerTask: public util::DeadlineQueue::Entry {
   public:
     virtual void timerTaskRun() = 0;
   };
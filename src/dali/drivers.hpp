@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * Licensed under GNU General Public License 3.0 or later.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef DALI_DRIVERS_HPP_
+#define DALI_DRIVERS_HPP_
+
+#include "dali.hpp"
+#include "dali_dt8.hpp"
+
+// Driver types used by the controllers. By default the drivers are called
+// through the interfaces. A platform with exactly one (final) implementation
+// of each driver binds the concrete classes by defining DALI_DRIVERS_HEADER,
+// so the calls are resolved at compile time. Tests always use the interfaces
+// to run against the mocks.
+#if defined(DALI_DRIVERS_HEADER) && !defined(DALI_TEST)
+
+#include DALI_DRIVERS_HEADER
+
+#else
+
+namespace dali {
+
+typedef IMemory MemoryDriver;
+typedef ILamp LampDriver;
+typedef IBusDriver BusDriver;
+typedef ITimer TimerDriver;
+#ifdef DALI_DT8
+typedef ILampDT8 LampDT8Driver;
+#endif // DALI_DT8
+
+} // namespace dali
+
+#endif // DALI_DRIVERS_HEADER
+
+#endif // DALI_DRIVERS_HPP_
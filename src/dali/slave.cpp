@@ -10,18 +10,16 @@
 
 #include "slave.hpp"
 
+#include "command_descriptor.hpp"
+
 namespace dali {
 
 // static
-Slave* Slave::create(IBusDriver* busDriver, ITimer* timer, IMemory* memoryDriver, ILamp* lampDriver) {
-  controller::Memory* memory = new controller::Memory(memoryDriver);
-  controller::Lamp* lamp = new controller::Lamp(lampDriver, memory);
-  controller::QueryStore* queryStore = new controller::QueryStore(memory, lamp);
-
-  return new Slave(busDriver, timer, memory, lamp, queryStore);
+Slave* Slave::create(BusDriver* busDriver, TimerDriver* timer, MemoryDriver* memoryDriver, LampDriver* lampDriver) {
+  return new SlaveStorage<SlaveConfig>(busDriver, timer, memoryDriver, lampDriver);
 }
 
-Slave::Slave(IBusDriver* busDriver, ITimer* timer, controller::Memory* memory, controller::Lamp* lamp,
+Slave::Slave(BusDriver* busDriver, TimerDriver* timer, controller::Memory* memory, controller::Lamp* lamp,
     controller::QueryStore* queryStore) :
     mBusController(busDriver, this),
     mInitializationController(timer, memory),
@@ -31,13 +29,13 @@ Slave::Slave(IBusDriver* busDriver, ITimer* timer, controller::Memory* memory, c
     mMemoryWriteEnabled(false),
     mDeviceType(0xff) {
   mLampController->setListener(this);
+  mMemoryController->setListener(this);
+  onAddressChanged();
 }
 
 Slave::~Slave() {
+  mMemoryController->setListener(nullptr);
   mLampController->setListener(nullptr);
-  delete mQueryStoreController;
-  delete mLampController;
-  delete mMemoryController;
 }
 
 void Slave::notifyPowerUp() {
@@ -52,12 +50,8 @@ void Slave::onLampStateChnaged(ILamp::ILampState state) {
   mInitializationController.onLampStateChnaged(state);
 }
 
-uint8_t Slave::getShortAddr() {
-  return mMemoryController->getShortAddr();
-}
-
-uint16_t Slave::getGroups() {
-  return mMemoryController->getGroups();
+void Slave::onAddressChanged() {
+  mBusController.setAddress(mMemoryController->getShortAddr(), mMemoryController->getGroups());
 }
 
 void Slave::onBusDisconnected() {
@@ -68,439 +62,605 @@ Status Slave::handleHandleDaliDeviceTypeCommand(uint16_t repeat, Command cmd, ui
   return Status::INVALID;
 }
 
-Status Slave::handleCommand(uint16_t repeatCount, Command cmd, uint8_t param) {
-  // check memory write
-  switch (cmd) {
-  case Command::ENABLE_WRITE_MEMORY:
-  case Command::WRITE_MEMORY_LOCATION:
-    break;
-
-  case Command::ENABLE_DEVICE_TYPE_X:
-    mDeviceType = param;
-    return Status::OK;
-
-  default:
-    mMemoryWriteEnabled = false;
-  }
-
-  Status status = internalHandleDaliDT8Command(repeatCount, cmd, param);
-  if (status != Status::REPEAT_REQUIRED) {
-    mDeviceType = 0xff;
-  }
-  return status;
-}
-
 Status Slave::handleIgnoredCommand(Command cmd, uint8_t param) {
   mDeviceType = 0xff;
   return Status::INVALID;
 }
 
-Status Slave::internalHandleDaliDT8Command(uint16_t repeatCount, Command cmd, uint8_t param) {
+class SlaveCommands {
+public:
+  typedef CommandDescriptor<Slave> Descriptor;
 
-  // handle commands
-  switch (cmd) {
+  static Descriptor get(Command cmd);
 
-  case Command::OFF:
-    return mLampController->powerOff();
+  static Status off(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mLampController->powerOff();
+  }
 
-  case Command::UP:
-    return mLampController->powerUp();
+  static Status up(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mLampController->powerUp();
+  }
 
-  case Command::DOWN:
-    return mLampController->powerDown();
+  static Status down(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mLampController->powerDown();
+  }
 
-  case Command::STEP_UP:
-    return mLampController->powerStepUp();
+  static Status stepUp(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mLampController->powerStepUp();
+  }
 
-  case Command::STEP_DOWN:
-    return mLampController->powerStepDown();
+  static Status stepDown(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mLampController->powerStepDown();
+  }
 
-  case Command::RECALL_MAX_LEVEL:
-    return mLampController->powerRecallMaxLevel();
+  static Status recallMaxLevel(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mLampController->powerRecallMaxLevel();
+  }
 
-  case Command::RECALL_MIN_LEVEL:
-    return mLampController->powerRecallMinLevel();
+  static Status recallMinLevel(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mLampController->powerRecallMinLevel();
+  }
 
-  case Command::STEP_DOWN_AND_OFF:
-    return mLampController->powerStepDownAndOff();
+  static Status stepDownAndOff(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mLampController->powerStepDownAndOff();
+  }
 
-  case Command::ON_AND_STEP_UP:
-    return mLampController->powerOnAndStepUp();
+  static Status onAndStepUp(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mLampController->powerOnAndStepUp();
+  }
 
-  case Command::ENABLE_DAPC_SEQUENCE:
-    return mLampController->enableDapcSequence(mBusController.getLastCommandTime());
+  static Status enableDapcSequence(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mLampController->enableDapcSequence(s->mBusController.getLastCommandTime());
+  }
 
-  case Command::GO_TO_SCENE_0:
-  case Command::GO_TO_SCENE_1:
-  case Command::GO_TO_SCENE_2:
-  case Command::GO_TO_SCENE_3:
-  case Command::GO_TO_SCENE_4:
-  case Command::GO_TO_SCENE_5:
-  case Command::GO_TO_SCENE_6:
-  case Command::GO_TO_SCENE_7:
-  case Command::GO_TO_SCENE_8:
-  case Command::GO_TO_SCENE_9:
-  case Command::GO_TO_SCENE_A:
-  case Command::GO_TO_SCENE_B:
-  case Command::GO_TO_SCENE_C:
-  case Command::GO_TO_SCENE_D:
-  case Command::GO_TO_SCENE_E:
-  case Command::GO_TO_SCENE_F:
-    return mLampController->powerScene(((uint8_t) cmd) & 0x0f);
+  static Status goToScene(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mLampController->powerScene(((uint8_t) cmd) & 0x0f);
+  }
 
-  case Command::RESET:
-    if (repeatCount == 0) {
-      return Status::REPEAT_REQUIRED;
-    }
-    mInitializationController.reset();
-    mQueryStoreController->reset();
+  static Status reset(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    s->mInitializationController.reset();
+    s->mQueryStoreController->reset();
     return Status::OK;
+  }
 
-  case Command::STORE_ACTUAL_LEVEL_IN_DTR:
-    if (repeatCount == 0) {
-      return Status::REPEAT_REQUIRED;
-    }
-    return mQueryStoreController->storeActualLevelInDtr();
+  static Status storeActualLevelInDtr(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mQueryStoreController->storeActualLevelInDtr();
+  }
 
-  case Command::STORE_DTR_AS_MAX_LEVEL:
-    if (repeatCount == 0) {
-      return Status::REPEAT_REQUIRED;
-    }
-    return mQueryStoreController->storeDtrAsMaxLevel();
+  static Status storeDtrAsMaxLevel(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mQueryStoreController->storeDtrAsMaxLevel();
+  }
 
-  case Command::STORE_DTR_AS_MIN_LEVEL:
-    if (repeatCount == 0) {
-      return Status::REPEAT_REQUIRED;
-    }
-    return mQueryStoreController->storeDtrAsMinLevel();
+  static Status storeDtrAsMinLevel(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mQueryStoreController->storeDtrAsMinLevel();
+  }
 
-  case Command::STORE_DTR_AS_SYS_FAIL_LEVEL:
-    if (repeatCount == 0) {
-      return Status::REPEAT_REQUIRED;
-    }
-    return mQueryStoreController->storeDtrAsFailureLevel();
+  static Status storeDtrAsFailureLevel(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mQueryStoreController->storeDtrAsFailureLevel();
+  }
 
-  case Command::STORE_DTR_AS_POWER_ON_LEVEL:
-    if (repeatCount == 0) {
-      return Status::REPEAT_REQUIRED;
-    }
-    return mQueryStoreController->storePowerOnLevel();
+  static Status storePowerOnLevel(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mQueryStoreController->storePowerOnLevel();
+  }
 
-  case Command::STORE_DTR_AS_FADE_TIME:
-    if (repeatCount == 0) {
-      return Status::REPEAT_REQUIRED;
-    }
-    return mQueryStoreController->storeDtrAsFadeTime();
+  static Status storeDtrAsFadeTime(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mQueryStoreController->storeDtrAsFadeTime();
+  }
 
-  case Command::STORE_DTR_AS_FADE_RATE:
-    if (repeatCount == 0) {
-      return Status::REPEAT_REQUIRED;
-    }
-    return mQueryStoreController->storeDtrAsFadeRate();
-
-  case Command::STORE_DTR_AS_SCENE_0:
-  case Command::STORE_DTR_AS_SCENE_1:
-  case Command::STORE_DTR_AS_SCENE_2:
-  case Command::STORE_DTR_AS_SCENE_3:
-  case Command::STORE_DTR_AS_SCENE_4:
-  case Command::STORE_DTR_AS_SCENE_5:
-  case Command::STORE_DTR_AS_SCENE_6:
-  case Command::STORE_DTR_AS_SCENE_7:
-  case Command::STORE_DTR_AS_SCENE_8:
-  case Command::STORE_DTR_AS_SCENE_9:
-  case Command::STORE_DTR_AS_SCENE_A:
-  case Command::STORE_DTR_AS_SCENE_B:
-  case Command::STORE_DTR_AS_SCENE_C:
-  case Command::STORE_DTR_AS_SCENE_D:
-  case Command::STORE_DTR_AS_SCENE_E:
-  case Command::STORE_DTR_AS_SCENE_F:
-    if (repeatCount == 0) {
-      return Status::REPEAT_REQUIRED;
-    }
-    return mQueryStoreController->storeDtrAsScene(((uint8_t) cmd) & 0x0f);
-
-  case Command::REMOVE_FROM_SCENE_0:
-  case Command::REMOVE_FROM_SCENE_1:
-  case Command::REMOVE_FROM_SCENE_2:
-  case Command::REMOVE_FROM_SCENE_3:
-  case Command::REMOVE_FROM_SCENE_4:
-  case Command::REMOVE_FROM_SCENE_5:
-  case Command::REMOVE_FROM_SCENE_6:
-  case Command::REMOVE_FROM_SCENE_7:
-  case Command::REMOVE_FROM_SCENE_8:
-  case Command::REMOVE_FROM_SCENE_9:
-  case Command::REMOVE_FROM_SCENE_A:
-  case Command::REMOVE_FROM_SCENE_B:
-  case Command::REMOVE_FROM_SCENE_C:
-  case Command::REMOVE_FROM_SCENE_D:
-  case Command::REMOVE_FROM_SCENE_E:
-  case Command::REMOVE_FROM_SCENE_F:
-    if (repeatCount == 0) {
-      return Status::REPEAT_REQUIRED;
-    }
-    return mQueryStoreController->removeFromScene(((uint8_t) cmd) & 0x0f);
-
-  case Command::ADD_TO_GROUP_0:
-  case Command::ADD_TO_GROUP_1:
-  case Command::ADD_TO_GROUP_2:
-  case Command::ADD_TO_GROUP_3:
-  case Command::ADD_TO_GROUP_4:
-  case Command::ADD_TO_GROUP_5:
-  case Command::ADD_TO_GROUP_6:
-  case Command::ADD_TO_GROUP_7:
-  case Command::ADD_TO_GROUP_8:
-  case Command::ADD_TO_GROUP_9:
-  case Command::ADD_TO_GROUP_A:
-  case Command::ADD_TO_GROUP_B:
-  case Command::ADD_TO_GROUP_C:
-  case Command::ADD_TO_GROUP_D:
-  case Command::ADD_TO_GROUP_E:
-  case Command::ADD_TO_GROUP_F:
-    if (repeatCount == 0) {
-      return Status::REPEAT_REQUIRED;
-    }
-    return mQueryStoreController->addToGroup(((uint8_t) cmd) & 0x0f);
-
-  case Command::REMOVE_FROM_GROUP_0:
-  case Command::REMOVE_FROM_GROUP_1:
-  case Command::REMOVE_FROM_GROUP_2:
-  case Command::REMOVE_FROM_GROUP_3:
-  case Command::REMOVE_FROM_GROUP_4:
-  case Command::REMOVE_FROM_GROUP_5:
-  case Command::REMOVE_FROM_GROUP_6:
-  case Command::REMOVE_FROM_GROUP_7:
-  case Command::REMOVE_FROM_GROUP_8:
-  case Command::REMOVE_FROM_GROUP_9:
-  case Command::REMOVE_FROM_GROUP_A:
-  case Command::REMOVE_FROM_GROUP_B:
-  case Command::REMOVE_FROM_GROUP_C:
-  case Command::REMOVE_FROM_GROUP_D:
-  case Command::REMOVE_FROM_GROUP_E:
-  case Command::REMOVE_FROM_GROUP_F:
-    if (repeatCount == 0) {
-      return Status::REPEAT_REQUIRED;
-    }
-    return mQueryStoreController->removeFromGroup(((uint8_t) cmd) & 0x0f);
+  static Status storeDtrAsFadeRate(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mQueryStoreController->storeDtrAsFadeRate();
+  }
 
-  case Command::STORE_DTR_AS_SHORT_ADDR:
-    if (repeatCount == 0) {
-      return Status::REPEAT_REQUIRED;
-    }
-    return mQueryStoreController->storeDtrAsShortAddr();
+  static Status storeDtrAsScene(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mQueryStoreController->storeDtrAsScene(((uint8_t) cmd) & 0x0f);
+  }
 
-  case Command::ENABLE_WRITE_MEMORY:
-    if (repeatCount == 0) {
-      return Status::REPEAT_REQUIRED;
-    }
-    mMemoryWriteEnabled = true;
-    return Status::OK;
+  static Status removeFromScene(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mQueryStoreController->removeFromScene(((uint8_t) cmd) & 0x0f);
+  }
 
-  case Command::QUERY_STATUS:
-    return sendAck(mQueryStoreController->queryStatus());
+  static Status addToGroup(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mQueryStoreController->addToGroup(((uint8_t) cmd) & 0x0f);
+  }
 
-  case Command::QUERY_CONTROL_GEAR:
-    return sendAck(DALI_ACK_YES);
+  static Status removeFromGroup(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mQueryStoreController->removeFromGroup(((uint8_t) cmd) & 0x0f);
+  }
 
-  case Command::QUERY_LAMP_FAILURE:
-    if (mQueryStoreController->queryLampFailure()) {
-      return sendAck(DALI_ACK_YES);
-    }
-    return Status::OK;
+  static Status storeDtrAsShortAddr(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mQueryStoreController->storeDtrAsShortAddr();
+  }
 
-  case Command::QUERY_LAMP_POWER_ON:
-    if (mQueryStoreController->queryLampPowerOn()) {
-      return sendAck(DALI_ACK_YES);
-    }
+  static Status enableWriteMemory(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    s->mMemoryWriteEnabled = true;
     return Status::OK;
+  }
 
-  case Command::QUERY_LIMIT_ERROR:
-    if (mQueryStoreController->queryLampLimitError()) {
-      return sendAck(DALI_ACK_YES);
-    }
-    return Status::OK;
+  static Status queryStatus(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->sendAck(s->mQueryStoreController->queryStatus());
+  }
 
-  case Command::QUERY_RESET_STATE:
-    if (mQueryStoreController->queryResetState()) {
-      return sendAck(DALI_ACK_YES);
-    }
-    return Status::OK;
+  static Status queryControlGear(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->sendAck(DALI_ACK_YES);
+  }
 
-  case Command::QUERY_MISSING_SHORT_ADDR: {
-    if (mQueryStoreController->queryMissingShortAddr()) {
-      return sendAck(DALI_ACK_YES);
-    }
-    return Status::OK;
+  static Status queryLampFailure(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return sendYesIf(s, s->mQueryStoreController->queryLampFailure());
   }
 
-  case Command::QUERY_VERSION_NUMBER:
-    return sendAck(DALI_VERSION);
+  static Status queryLampPowerOn(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return sendYesIf(s, s->mQueryStoreController->queryLampPowerOn());
+  }
 
-  case Command::QUERY_CONTENT_DTR:
-    return sendAck(mMemoryController->getDTR());
+  static Status queryLimitError(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return sendYesIf(s, s->mQueryStoreController->queryLampLimitError());
+  }
 
-  case Command::QUERY_DEVICE_TYPE:
-    return sendAck(DALI_DEVICE_TYPE);
+  static Status queryResetState(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return sendYesIf(s, s->mQueryStoreController->queryResetState());
+  }
 
-  case Command::QUERY_PHISICAL_MIN_LEVEL:
-    return sendAck(mMemoryController->getPhisicalMinLevel());
+  static Status queryMissingShortAddr(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return sendYesIf(s, s->mQueryStoreController->queryMissingShortAddr());
+  }
 
-  case Command::QUERY_POWER_FAILURE:
-    if (!mQueryStoreController->queryLampPowerSet()) {
-      return sendAck(DALI_ACK_YES);
-    }
-    return Status::OK;
+  static Status queryVersionNumber(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->sendAck(DALI_VERSION);
+  }
 
-  case Command::QUERY_CONTENT_DTR1:
-    return sendAck(mMemoryController->getDTR1());
+  static Status queryContentDtr(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->sendAck(s->mMemoryController->getDTR());
+  }
 
-  case Command::QUERY_CONTENT_DTR2:
-    return sendAck(mMemoryController->getDTR2());
+  static Status queryDeviceType(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->sendAck(DALI_DEVICE_TYPE);
+  }
 
-  case Command::QUERY_ACTUAL_LEVEL:
-    return sendAck(mQueryStoreController->queryActualLevel());
+  static Status queryPhisicalMinLevel(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->sendAck(s->mMemoryController->getPhisicalMinLevel());
+  }
 
-  case Command::QUERY_MAX_LEVEL:
-    return sendAck(mQueryStoreController->queryMaxLevel());
+  static Status queryPowerFailure(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return sendYesIf(s, !s->mQueryStoreController->queryLampPowerSet());
+  }
 
-  case Command::QUERY_MIN_LEVEL:
-    return sendAck(mQueryStoreController->queryMinLevel());
+  static Status queryContentDtr1(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->sendAck(s->mMemoryController->getDTR1());
+  }
 
-  case Command::QUERY_POWER_ON_LEVEL:
-    return sendAck(mQueryStoreController->queryPowerOnLevel());
+  static Status queryContentDtr2(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->sendAck(s->mMemoryController->getDTR2());
+  }
 
-  case Command::QUERY_SYS_FAILURE_LEVEL:
-    return sendAck(mQueryStoreController->queryFaliureLevel());
+  static Status queryActualLevel(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->sendAck(s->mQueryStoreController->queryActualLevel());
+  }
 
-  case Command::QUERY_FADE_TIME_OR_RATE:
-    return sendAck(mQueryStoreController->queryFadeRateOrTime());
+  static Status queryMaxLevel(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->sendAck(s->mQueryStoreController->queryMaxLevel());
+  }
 
-  case Command::QUERY_SCENE_0_LEVEL:
-  case Command::QUERY_SCENE_1_LEVEL:
-  case Command::QUERY_SCENE_2_LEVEL:
-  case Command::QUERY_SCENE_3_LEVEL:
-  case Command::QUERY_SCENE_4_LEVEL:
-  case Command::QUERY_SCENE_5_LEVEL:
-  case Command::QUERY_SCENE_6_LEVEL:
-  case Command::QUERY_SCENE_7_LEVEL:
-  case Command::QUERY_SCENE_8_LEVEL:
-  case Command::QUERY_SCENE_9_LEVEL:
-  case Command::QUERY_SCENE_A_LEVEL:
-  case Command::QUERY_SCENE_B_LEVEL:
-  case Command::QUERY_SCENE_C_LEVEL:
-  case Command::QUERY_SCENE_D_LEVEL:
-  case Command::QUERY_SCENE_E_LEVEL:
-  case Command::QUERY_SCENE_F_LEVEL:
-    return sendAck(mQueryStoreController->queryLevelForScene(((uint8_t) cmd) & 0xf));
+  static Status queryMinLevel(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->sendAck(s->mQueryStoreController->queryMinLevel());
+  }
 
-  case Command::QUERY_GROUPS_L:
-    return sendAck(mQueryStoreController->queryGroupsL());
+  static Status queryPowerOnLevel(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->sendAck(s->mQueryStoreController->queryPowerOnLevel());
+  }
 
-  case Command::QUERY_GROUPS_H:
-    return sendAck(mQueryStoreController->queryGroupsH());
+  static Status querySysFailureLevel(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->sendAck(s->mQueryStoreController->queryFaliureLevel());
+  }
 
-  case Command::QUERY_RANDOM_ADDR_H:
-    return sendAck(mQueryStoreController->queryRandomAddrH());
+  static Status queryFadeTimeOrRate(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->sendAck(s->mQueryStoreController->queryFadeRateOrTime());
+  }
 
-  case Command::QUERY_RANDOM_ADDR_M:
-    return sendAck(mQueryStoreController->queryRandomAddrM());
+  static Status querySceneLevel(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->sendAck(s->mQueryStoreController->queryLevelForScene(((uint8_t) cmd) & 0xf));
+  }
 
-  case Command::QUERY_RANDOM_ADDR_L:
-    return sendAck(mQueryStoreController->queryRandomAddrL());
+  static Status queryGroupsL(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->sendAck(s->mQueryStoreController->queryGroupsL());
+  }
 
-  case Command::READ_MEMORY_LOCATION: {
+  static Status queryGroupsH(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->sendAck(s->mQueryStoreController->queryGroupsH());
+  }
+
+  static Status queryRandomAddrH(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->sendAck(s->mQueryStoreController->queryRandomAddrH());
+  }
+
+  static Status queryRandomAddrM(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->sendAck(s->mQueryStoreController->queryRandomAddrM());
+  }
+
+  static Status queryRandomAddrL(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->sendAck(s->mQueryStoreController->queryRandomAddrL());
+  }
+
+  static Status readMemoryLocation(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
     uint8_t data = 0;
-    if (mMemoryController->readMemory(&data) != Status::OK) {
+    if (s->mMemoryController->readMemory(&data) != Status::OK) {
       return Status::ERROR;
     }
-    return sendAck(data);
+    return s->sendAck(data);
   }
 
-    // extended commands
+  // extended commands
 
-  case Command::DIRECT_POWER_CONTROL:
-    return mLampController->powerDirect(param, mBusController.getLastCommandTime());
+  static Status directPowerControl(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mLampController->powerDirect(param, s->mBusController.getLastCommandTime());
+  }
 
-  case Command::TERMINATE:
-    return mInitializationController.terminate();
+  static Status terminate(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mInitializationController.terminate();
+  }
 
-  case Command::DATA_TRANSFER_REGISTER:
-    mMemoryController->setDTR(param);
+  static Status dataTransferRegister(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    s->mMemoryController->setDTR(param);
     return Status::OK;
+  }
 
-  case Command::INITIALISE:
-    if (repeatCount == 0) {
-      return Status::REPEAT_REQUIRED;
-    }
-    return mInitializationController.initialize(param);
+  static Status initialise(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mInitializationController.initialize(param);
+  }
 
-  case Command::RANDOMISE:
-    if (repeatCount == 0) {
-      return Status::REPEAT_REQUIRED;
-    }
-    return mInitializationController.randomize();
+  static Status randomise(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mInitializationController.randomize();
+  }
 
-  case Command::COMPARE: {
-    Status status = mInitializationController.compare();
-    if (status == Status::OK) {
-      return mBusController.sendAck(DALI_ACK_YES);
-    }
-    return status;
+  static Status compare(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return sendYesIfOk(s, s->mInitializationController.compare());
   }
-  case Command::WITHDRAW:
-    return mInitializationController.withdraw();
 
-  case Command::SEARCHADDRH:
-    return mInitializationController.searchAddrH(param);
+  static Status withdraw(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mInitializationController.withdraw();
+  }
 
-  case Command::SEARCHADDRM:
-    return mInitializationController.searchAddrM(param);
+  static Status searchAddrH(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mInitializationController.searchAddrH(param);
+  }
 
-  case Command::SEARCHADDRL:
-    return mInitializationController.searchAddrL(param);
+  static Status searchAddrM(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mInitializationController.searchAddrM(param);
+  }
 
-  case Command::PROGRAM_SHORT_ADDRESS:
-    return mInitializationController.programShortAddr(param);
+  static Status searchAddrL(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mInitializationController.searchAddrL(param);
+  }
 
-  case Command::VERIFY_SHORT_ADDRESS: {
-    Status status = mInitializationController.verifySortAddr(param);
-    if (status == Status::OK) {
-      return mBusController.sendAck(DALI_ACK_YES);
-    }
-    return status;
+  static Status programShortAddress(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mInitializationController.programShortAddr(param);
+  }
+
+  static Status verifyShortAddress(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return sendYesIfOk(s, s->mInitializationController.verifySortAddr(param));
   }
-  case Command::QUERY_SHORT_ADDRESS: {
+
+  static Status queryShortAddress(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
     uint8_t shortAddr;
-    Status status = mInitializationController.queryShortAddr(&shortAddr);
+    Status status = s->mInitializationController.queryShortAddr(&shortAddr);
     if (status == Status::OK) {
-      return mBusController.sendAck(shortAddr);
+      return s->sendAck(shortAddr);
     }
     return status;
   }
-  case Command::PHYSICAL_SELECTION:
-    return mInitializationController.physicalSelection();
 
-  case Command::DATA_TRANSFER_REGISTER_1:
-    mMemoryController->setDTR1(param);
+  static Status physicalSelection(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->mInitializationController.physicalSelection();
+  }
+
+  static Status enableDeviceTypeX(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    s->mDeviceType = param;
     return Status::OK;
+  }
+
+  static Status dataTransferRegister1(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    s->mMemoryController->setDTR1(param);
+    return Status::OK;
+  }
 
-  case Command::DATA_TRANSFER_REGISTER_2:
-    mMemoryController->setDTR2(param);
+  static Status dataTransferRegister2(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    s->mMemoryController->setDTR2(param);
     return Status::OK;
+  }
 
-  case Command::WRITE_MEMORY_LOCATION:
-    if (!mMemoryWriteEnabled) {
+  static Status writeMemoryLocation(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    if (!s->mMemoryWriteEnabled) {
       return Status::ERROR;
     }
-    switch (mMemoryController->writeMemory(param)) {
+    switch (s->mMemoryController->writeMemory(param)) {
     case Status::OK:
-      return sendAck(param);
+      return s->sendAck(param);
     default:
       return Status::ERROR;
     }
+  }
+
+  // bulk programming without the backward frames
+  static Status writeMemoryLocationNoReply(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    if (!s->mMemoryWriteEnabled) {
+      return Status::ERROR;
+    }
+    return s->mMemoryController->writeMemory(param) == Status::OK ? Status::OK : Status::ERROR;
+  }
 
-  default:
-    return handleHandleDaliDeviceTypeCommand(repeatCount, cmd, param, mDeviceType);
+  // reserved or application extended commands
+  static Status deviceType(Slave* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->handleHandleDaliDeviceTypeCommand(repeat, cmd, param, s->mDeviceType);
   }
+
+private:
+  static Status sendYesIf(Slave* s, bool condition) {
+    if (condition) {
+      return s->sendAck(DALI_ACK_YES);
+    }
+    return Status::OK;
+  }
+
+  static Status sendYesIfOk(Slave* s, Status status) {
+    if (status == Status::OK) {
+      return s->sendAck(DALI_ACK_YES);
+    }
+    return status;
+  }
+};
+
+namespace {
+
+typedef SlaveCommands::Descriptor Descriptor;
+
+// standard commands 0-255, DIRECT_POWER_CONTROL, special commands 0xa1-0xc9 (odd only)
+const uint16_t kCommandCodesCount = 256 + 1 + 21;
+
+constexpr uint16_t commandCode(Command cmd) {
+  return (uint16_t) cmd < 256 ? (uint16_t) cmd :
+      cmd == Command::DIRECT_POWER_CONTROL ? 256 :
+      ((uint16_t) cmd >= (uint16_t) Command::TERMINATE)
+          && ((uint16_t) cmd <= (uint16_t) Command::WRITE_MEMORY_LOCATION_NO_REPLY) && (((uint16_t) cmd & 0x01) != 0) ? 257 + ((uint16_t) cmd - (uint16_t) Command::TERMINATE) / 2 :
+      kCommandCodesCount;
+}
+
+typedef struct {
+  uint16_t first;
+  uint16_t last;
+} CommandRange;
+
+// the reserved codes between the ranges have no entries in the table
+constexpr CommandRange kRanges[] = {
+    { (uint16_t) Command::OFF, (uint16_t) Command::ENABLE_DAPC_SEQUENCE },
+    { (uint16_t) Command::GO_TO_SCENE_0, (uint16_t) Command::STORE_ACTUAL_LEVEL_IN_DTR },
+    { (uint16_t) Command::STORE_DTR_AS_MAX_LEVEL, (uint16_t) Command::STORE_DTR_AS_FADE_RATE },
+    { (uint16_t) Command::STORE_DTR_AS_SCENE_0, (uint16_t) Command::ENABLE_WRITE_MEMORY },
+    { (uint16_t) Command::QUERY_STATUS, (uint16_t) Command::QUERY_CONTENT_DTR2 },
+    { (uint16_t) Command::QUERY_ACTUAL_LEVEL, (uint16_t) Command::QUERY_FADE_TIME_OR_RATE },
+    { (uint16_t) Command::QUERY_SCENE_0_LEVEL, (uint16_t) Command::READ_MEMORY_LOCATION },
+    { commandCode(Command::DIRECT_POWER_CONTROL), commandCode(Command::WRITE_MEMORY_LOCATION_NO_REPLY) },
+};
+
+const uint8_t kRangesCount = sizeof(kRanges) / sizeof(kRanges[0]);
+
+constexpr uint16_t commandsCount(uint8_t range) {
+  return range == kRangesCount ? 0 : kRanges[range].last - kRanges[range].first + 1 + commandsCount(range + 1);
+}
+
+const uint16_t kCommandsCount = commandsCount(0);
+
+constexpr uint16_t codeIndex(uint16_t code, uint8_t range, uint16_t index) {
+  return (range == kRangesCount) || (code < kRanges[range].first) ? kCommandsCount :
+      code <= kRanges[range].last ? index + code - kRanges[range].first :
+      codeIndex(code, range + 1, index + kRanges[range].last - kRanges[range].first + 1);
+}
+
+constexpr uint16_t commandIndex(Command cmd) {
+  return codeIndex(commandCode(cmd), 0, 0);
+}
+
+// Run time map of the command codes to the table entries, one byte per code.
+// The reserved codes map to kCommandsCount.
+template<typename Codes>
+struct CodeIndexes;
+
+template<uint16_t... kCodes>
+struct CodeIndexes<CommandIndexes<kCodes...>> {
+  static constexpr uint8_t kIndexes[sizeof...(kCodes)] = { (uint8_t) codeIndex(kCodes, 0, 0)... };
+};
+
+template<uint16_t... kCodes>
+constexpr uint8_t CodeIndexes<CommandIndexes<kCodes...>>::kIndexes[sizeof...(kCodes)];
+
+typedef CodeIndexes<MakeCommandIndexes<kCommandCodesCount>::Type> CodeMap;
+
+constexpr Descriptor command(Status (*handler)(Slave*, uint16_t, Command, uint8_t), uint8_t flags) {
+  return Descriptor { handler, flags };
+}
+
+#define COMMAND(handler, flags) command(&SlaveCommands::handler, flags)
+#define ACTION(handler) COMMAND(handler, kCommandClearsWriteEnable)
+#define CONFIG(handler) COMMAND(handler, kCommandClearsWriteEnable | kCommandSendTwice)
+#define QUERY(handler) COMMAND(handler, kCommandClearsWriteEnable | kCommandAnswers)
+#define NONE ACTION(deviceType)
+#define X2(entry) entry, entry
+#define X4(entry) X2(entry), X2(entry)
+#define X8(entry) X4(entry), X4(entry)
+#define X16(entry) X8(entry), X8(entry)
+
+// used at compile time only, Commands is the run time copy
+constexpr Descriptor kCommands[] = {
+    ACTION(off), // 0
+    ACTION(up),
+    ACTION(down),
+    ACTION(stepUp),
+    ACTION(stepDown),
+    ACTION(recallMaxLevel),
+    ACTION(recallMinLevel),
+    ACTION(stepDownAndOff),
+    ACTION(onAndStepUp),
+    ACTION(enableDapcSequence),
+    X16(ACTION(goToScene)), // 16-31
+    CONFIG(reset), // 32
+    CONFIG(storeActualLevelInDtr),
+    CONFIG(storeDtrAsMaxLevel), // 42
+    CONFIG(storeDtrAsMinLevel),
+    CONFIG(storeDtrAsFailureLevel),
+    CONFIG(storePowerOnLevel),
+    CONFIG(storeDtrAsFadeTime),
+    CONFIG(storeDtrAsFadeRate),
+    X16(CONFIG(storeDtrAsScene)), // 64-79
+    X16(CONFIG(removeFromScene)), // 80-95
+    X16(CONFIG(addToGroup)), // 96-111
+    X16(CONFIG(removeFromGroup)), // 112-127
+    CONFIG(storeDtrAsShortAddr), // 128
+    COMMAND(enableWriteMemory, kCommandSendTwice),
+    QUERY(queryStatus), // 144
+    QUERY(queryControlGear),
+    QUERY(queryLampFailure),
+    QUERY(queryLampPowerOn),
+    QUERY(queryLimitError),
+    QUERY(queryResetState),
+    QUERY(queryMissingShortAddr),
+    QUERY(queryVersionNumber),
+    QUERY(queryContentDtr),
+    QUERY(queryDeviceType),
+    QUERY(queryPhisicalMinLevel),
+    QUERY(queryPowerFailure),
+    QUERY(queryContentDtr1),
+    QUERY(queryContentDtr2),
+    QUERY(queryActualLevel), // 160
+    QUERY(queryMaxLevel),
+    QUERY(queryMinLevel),
+    QUERY(queryPowerOnLevel),
+    QUERY(querySysFailureLevel),
+    QUERY(queryFadeTimeOrRate),
+    X16(QUERY(querySceneLevel)), // 176-191
+    QUERY(queryGroupsL), // 192
+    QUERY(queryGroupsH),
+    QUERY(queryRandomAddrH),
+    QUERY(queryRandomAddrM),
+    QUERY(queryRandomAddrL),
+    QUERY(readMemoryLocation),
+    ACTION(directPowerControl), // DIRECT_POWER_CONTROL
+    ACTION(terminate), // 0xa1
+    ACTION(dataTransferRegister),
+    CONFIG(initialise),
+    CONFIG(randomise),
+    QUERY(compare),
+    ACTION(withdraw),
+    NONE, // 0xad
+    NONE, // 0xaf
+    ACTION(searchAddrH), // 0xb1
+    ACTION(searchAddrM),
+    ACTION(searchAddrL),
+    ACTION(programShortAddress),
+    QUERY(verifyShortAddress),
+    QUERY(queryShortAddress),
+    ACTION(physicalSelection),
+    NONE, // 0xbf
+    COMMAND(enableDeviceTypeX, kCommandKeepsDeviceType), // 0xc1
+    ACTION(dataTransferRegister1),
+    ACTION(dataTransferRegister2),
+    COMMAND(writeMemoryLocation, kCommandAnswers), // 0xc7
+    COMMAND(writeMemoryLocationNoReply, 0), // 0xc9
+};
+
+#undef X16
+#undef X8
+#undef X4
+#undef X2
+#undef NONE
+#undef QUERY
+#undef CONFIG
+#undef ACTION
+#undef COMMAND
+
+typedef CommandTable<Slave, kCommands, MakeCommandIndexes<kCommandsCount>::Type> Commands;
+
+constexpr Descriptor kUnknownCommand = command(&SlaveCommands::deviceType, kCommandClearsWriteEnable);
+
+constexpr bool isHandler(Command cmd, Status (*handler)(Slave*, uint16_t, Command, uint8_t)) {
+  return kCommands[commandIndex(cmd)].handler == handler;
+}
+
+// query commands answer, configuration commands are send twice
+constexpr bool checkCommandFlags(uint16_t i, const Descriptor& d) {
+  return (d.handler == &SlaveCommands::deviceType || (d.is(kCommandAnswers) ==
+          ((i >= (uint16_t) Command::QUERY_STATUS && i < 256) || i == commandCode(Command::COMPARE)
+              || i == commandCode(Command::VERIFY_SHORT_ADDRESS) || i == commandCode(Command::QUERY_SHORT_ADDRESS)
+              || i == commandCode(Command::WRITE_MEMORY_LOCATION))))
+      && (d.is(kCommandSendTwice) ==
+          ((i >= (uint16_t) Command::RESET && i <= (uint16_t) Command::ENABLE_WRITE_MEMORY
+              && d.handler != &SlaveCommands::deviceType)
+              || i == commandCode(Command::INITIALISE) || i == commandCode(Command::RANDOMISE)));
+}
+
+constexpr bool checkFlags(uint16_t i) {
+  return i == kCommandCodesCount ? true :
+      (codeIndex(i, 0, 0) == kCommandsCount || checkCommandFlags(i, kCommands[codeIndex(i, 0, 0)]))
+      && checkFlags(i + 1);
+}
+
+static_assert(sizeof(kCommands) / sizeof(kCommands[0]) == kCommandsCount, "invalid commands table size");
+static_assert(commandIndex(Command::WRITE_MEMORY_LOCATION_NO_REPLY) == kCommandsCount - 1,
+    "invalid commands table size");
+static_assert(kCommandsCount < 256, "command index does not fit the code map");
+static_assert(CodeMap::kIndexes[commandCode(Command::READ_MEMORY_LOCATION)] == commandIndex(Command::READ_MEMORY_LOCATION),
+    "invalid code map");
+static_assert(commandIndex(Command::INVALID) == kCommandsCount, "invalid command index");
+static_assert(commandIndex((Command) 10) == kCommandsCount, "reserved command in the table");
+static_assert(commandIndex((Command) 255) == kCommandsCount, "reserved command in the table");
+static_assert(isHandler(Command::ENABLE_DAPC_SEQUENCE, &SlaveCommands::enableDapcSequence), "commands table mismatch");
+static_assert(isHandler(Command::GO_TO_SCENE_F, &SlaveCommands::goToScene), "commands table mismatch");
+static_assert(isHandler(Command::STORE_ACTUAL_LEVEL_IN_DTR, &SlaveCommands::storeActualLevelInDtr),
+    "commands table mismatch");
+static_assert(isHandler(Command::STORE_DTR_AS_FADE_RATE, &SlaveCommands::storeDtrAsFadeRate), "commands table mismatch");
+static_assert(isHandler(Command::REMOVE_FROM_GROUP_F, &SlaveCommands::removeFromGroup), "commands table mismatch");
+static_assert(isHandler(Command::ENABLE_WRITE_MEMORY, &SlaveCommands::enableWriteMemory), "commands table mismatch");
+static_assert(isHandler(Command::QUERY_CONTENT_DTR2, &SlaveCommands::queryContentDtr2), "commands table mismatch");
+static_assert(isHandler(Command::QUERY_FADE_TIME_OR_RATE, &SlaveCommands::queryFadeTimeOrRate),
+    "commands table mismatch");
+static_assert(isHandler(Command::QUERY_SCENE_F_LEVEL, &SlaveCommands::querySceneLevel), "commands table mismatch");
+static_assert(isHandler(Command::READ_MEMORY_LOCATION, &SlaveCommands::readMemoryLocation), "commands table mismatch");
+static_assert(isHandler(Command::DIRECT_POWER_CONTROL, &SlaveCommands::directPowerControl), "commands table mismatch");
+static_assert(isHandler(Command::WITHDRAW, &SlaveCommands::withdraw), "commands table mismatch");
+static_assert(isHandler(Command::SEARCHADDRH, &SlaveCommands::searchAddrH), "commands table mismatch");
+static_assert(isHandler(Command::PHYSICAL_SELECTION, &SlaveCommands::physicalSelection), "commands table mismatch");
+static_assert(isHandler(Command::ENABLE_DEVICE_TYPE_X, &SlaveCommands::enableDeviceTypeX), "commands table mismatch");
+static_assert(isHandler(Command::WRITE_MEMORY_LOCATION, &SlaveCommands::writeMemoryLocation),
+    "commands table mismatch");
+static_assert(isHandler(Command::WRITE_MEMORY_LOCATION_NO_REPLY, &SlaveCommands::writeMemoryLocationNoReply),
+    "commands table mismatch");
+static_assert(checkFlags(0), "invalid command flags");
+
+} // namespace
+
+// static
+SlaveCommands::Descriptor SlaveCommands::get(Command cmd) {
+  uint16_t code = commandCode(cmd);
+  if (code < kCommandCodesCount) {
+    uint8_t index = CodeMap::kIndexes[code];
+    if (index < kCommandsCount) {
+      return Commands::get(index);
+    }
+  }
+  return kUnknownCommand;
+}
+
+Status Slave::handleCommand(uint16_t repeatCount, Command cmd, uint8_t param) {
+  const SlaveCommands::Descriptor command = SlaveCommands::get(cmd);
+
+  if (command.is(kCommandClearsWriteEnable)) {
+    mMemoryWriteEnabled = false;
+  }
+  if (command.is(kCommandSendTwice) && (repeatCount == 0)) {
+    return Status::REPEAT_REQUIRED;
+  }
+  Status status = command.handler(this, repeatCount, cmd, param);
+  if ((status != Status::REPEAT_REQUIRED) && !command.is(kCommandKeepsDeviceType)) {
+    mDeviceType = 0xff;
+  }
+  return status;
 }
 
 }
@@ -20,10 +20,10 @@
 
 namespace dali {
 
-class Slave: public controller::Bus::Client, controller::Lamp::Listener
+class Slave: public controller::Bus::Client, controller::Lamp::Listener, controller::Memory::Listener
 {
 public:
-  static Slave* create(IBusDriver* busDriver, ITimer* timer, IMemory* memoryDriver, ILamp* lampDriver);
+  static Slave* create(BusDriver* busDriver, TimerDriver* timer, MemoryDriver* memoryDriver, LampDriver* lampDriver);
 
   virtual ~Slave();
 
@@ -31,7 +31,7 @@ public:
   void notifyPowerDown();
 
 protected:
-  Slave(IBusDriver* busDriver, ITimer* timer, controller::Memory* memory, controller::Lamp* lamp,
+  Slave(BusDriver* busDriver, TimerDriver* timer, controller::Memory* memory, controller::Lamp* lamp,
       controller::QueryStore* queryStore);
 
   controller::Memory* const getMemoryController() {
@@ -59,13 +59,15 @@ private:
   // LampController::Listener
   void onLampStateChnaged(ILamp::ILampState state) override;
 
+  // MemoryController::Listener
+  void onAddressChanged() override;
+
   // BusController::BusController
-  uint8_t getShortAddr() override;
-  uint16_t getGroups() override;
   void onBusDisconnected() override;
   Status handleCommand(uint16_t repeat, Command cmd, uint8_t param) override;
   Status handleIgnoredCommand(Command cmd, uint8_t param) override;
-  Status internalHandleDaliDT8Command(uint16_t repeat, Command cmd, uint8_t param);
+
+  friend class SlaveCommands;
 
   controller::Bus mBusController;
   controller::Initialization mInitializationController;
@@ -76,6 +78,37 @@ private:
   uint8_t mDeviceType;
 };
 
+// Controllers of the basic device, see SlaveStorage
+class SlaveConfig {
+public:
+  typedef Slave Device;
+
+protected:
+  SlaveConfig(MemoryDriver* memoryDriver, LampDriver* lampDriver) :
+      mMemory(memoryDriver), mLamp(lampDriver, &mMemory), mQueryStore(&mMemory, &mLamp) {
+  }
+
+  controller::Memory mMemory;
+  controller::Lamp mLamp;
+  controller::QueryStore mQueryStore;
+};
+
+// Slave together with its controllers in a single object, so the whole stack
+// can be placed statically without the heap. The controllers base is
+// constructed first and destroyed last.
+template<typename Config>
+class SlaveStorage: private Config, public Config::Device {
+public:
+  SlaveStorage(BusDriver* busDriver, TimerDriver* timer, MemoryDriver* memoryDriver, LampDriver* lampDriver) :
+      Config(memoryDriver, lampDriver),
+      Config::Device(busDriver, timer, &this->mMemory, &this->mLamp, &this->mQueryStore) {
+  }
+
+private:
+  SlaveStorage(const SlaveStorage& other) = delete;
+  SlaveStorage& operator=(const SlaveStorage&) = delete;
+};
+
 } // namespace dali
 
 #endif // DALI_SLAVE_H_
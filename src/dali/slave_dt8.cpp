@@ -10,141 +10,267 @@
 
 #include "slave_dt8.hpp"
 
+#include "command_descriptor.hpp"
+
 #ifdef DALI_DT8
 
 namespace dali {
 
 // static
-Slave* SlaveDT8::create(IMemory* memoryDriver, ILamp* lampDriver, IBus* busDriver, ITimer* timer) {
-  controller::MemoryDT8* memory = new controller::MemoryDT8(memoryDriver, &kDefaultsDT8);
-  controller::LampDT8* lamp = new controller::LampDT8(lampDriver, memory);
-  controller::QueryStoreDT8* queryStore = new controller::QueryStoreDT8(memory, lamp);
-  controller::Bus* bus = new controller::Bus(busDriver);
-  controller::Initialization* initialization = new controller::Initialization(timer, memory);
-
-  return new SlaveDT8(memory, lamp, queryStore, bus, initialization);
+Slave* SlaveDT8::create(BusDriver* busDriver, TimerDriver* timer, MemoryDriver* memoryDriver, LampDriver* lampDriver) {
+  return new SlaveStorage<SlaveDT8Config>(busDriver, timer, memoryDriver, lampDriver);
 }
 
-SlaveDT8::SlaveDT8(controller::Memory* memory, controller::Lamp* lamp, controller::QueryStore* queryStore,
-    controller::Bus* bus, controller::Initialization* initialization) :
-    Slave(memory, lamp, queryStore, bus, initialization) {
+SlaveDT8::SlaveDT8(BusDriver* busDriver, TimerDriver* timer, controller::MemoryDT8* memory, controller::LampDT8* lamp,
+    controller::QueryStoreDT8* queryStore) :
+    Slave(busDriver, timer, memory, lamp, queryStore) {
 }
 
-Status SlaveDT8::handleHandleDaliDeviceTypeCommand(uint16_t repeatCount, Command cmd, uint8_t param,
-    uint8_t device_type) {
-  if (device_type != 8) {
-    return Status::INVALID;
-  }
+class SlaveCommandsDT8 {
+public:
+  typedef CommandDescriptor<SlaveDT8> Descriptor;
 
-  CommandDT8 cmdDT8 = (CommandDT8)cmd;
+  static Descriptor get(Command cmd);
 
-  switch (cmdDT8) {
-  case CommandDT8::SET_TEMPORARY_X_COORDINATE_WORD:
-    return getQueryStoreControllerDT8()->setTemporaryCoordinateX();
+  static Status setTemporaryCoordinateX(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->getQueryStoreControllerDT8()->setTemporaryCoordinateX();
+  }
 
-  case CommandDT8::SET_TEMPORARY_Y_COORDINATE_WORD:
-    return getQueryStoreControllerDT8()->setTemporaryCoordinateY();
+  static Status setTemporaryCoordinateY(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->getQueryStoreControllerDT8()->setTemporaryCoordinateY();
+  }
 
-  case CommandDT8::ACTIVATE:
-    return getLampControllerDT8()->activate();
+  static Status activate(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->getLampControllerDT8()->activate();
+  }
 
 #ifdef DALI_DT8_SUPPORT_XY
-  case CommandDT8::X_COORDINATE_STEP_UP:
-    return getLampControllerDT8()->coordinateStepUpX();
+  static Status coordinateStepUpX(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->getLampControllerDT8()->coordinateStepUpX();
+  }
 
-  case CommandDT8::X_COORDINATE_STEP_DOWN:
-    return getLampControllerDT8()->coordinateStepDownX();
+  static Status coordinateStepDownX(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->getLampControllerDT8()->coordinateStepDownX();
+  }
 
-  case CommandDT8::Y_COORDINATE_STEP_UP:
-    return getLampControllerDT8()->coordinateStepUpY();
+  static Status coordinateStepUpY(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->getLampControllerDT8()->coordinateStepUpY();
+  }
 
-  case CommandDT8::Y_COORDINATE_STEP_DOWN:
-    return getLampControllerDT8()->coordinateStepDownY();
+  static Status coordinateStepDownY(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->getLampControllerDT8()->coordinateStepDownY();
+  }
 #endif // DALI_DT8_SUPPORT_XY
 
-  case CommandDT8::SET_TEMPORARY_COLOUR_TEMPERATURE:
-    return getQueryStoreControllerDT8()->setTemporaryColorTemperature();
+  static Status setTemporaryColorTemperature(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->getQueryStoreControllerDT8()->setTemporaryColorTemperature();
+  }
 
 #ifdef DALI_DT8_SUPPORT_TC
-  case CommandDT8::COLOUR_TEMPERATURE_STEP_COOLER:
-    return getLampControllerDT8()->colorTemperatureStepCooler();
+  static Status colorTemperatureStepCooler(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->getLampControllerDT8()->colorTemperatureStepCooler();
+  }
 
-  case CommandDT8::COLOUR_TEMPERATURE_STEP_WARMER:
-    return getLampControllerDT8()->colorTemperatureStepWarmer();
+  static Status colorTemperatureStepWarmer(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->getLampControllerDT8()->colorTemperatureStepWarmer();
+  }
 #endif // DALI_DT8_SUPPORT_TC
 
-  case CommandDT8::SET_TEMPORARY_PRIMARY_N_DIMLEVEL:
-    return getQueryStoreControllerDT8()->setTemporaryPrimaryLevel();
+  static Status setTemporaryPrimaryLevel(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->getQueryStoreControllerDT8()->setTemporaryPrimaryLevel();
+  }
 
-  case CommandDT8::SET_TEMPORARY_RGB_DIMLEVEL:
-    return getQueryStoreControllerDT8()->setTemporaryRGB();
+  static Status setTemporaryRGB(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->getQueryStoreControllerDT8()->setTemporaryRGB();
+  }
 
-  case CommandDT8::SET_TEMPORARY_WAF_DIMLEVEL:
-    return getQueryStoreControllerDT8()->setTemporaryWAF();
+  static Status setTemporaryWAF(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->getQueryStoreControllerDT8()->setTemporaryWAF();
+  }
 
-  case CommandDT8::SET_TEMPORARY_RGBWAF_CONTROL:
-    return getQueryStoreControllerDT8()->setTemporaryRGBWAFControl();
+  static Status setTemporaryRGBWAFControl(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->getQueryStoreControllerDT8()->setTemporaryRGBWAFControl();
+  }
 
-  case CommandDT8::COPY_REPORT_TO_TEMPORARY:
-    return getMemoryControllerDT8()->copyReportToTemporary();
+  static Status copyReportToTemporary(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->getMemoryControllerDT8()->copyReportToTemporary();
+  }
 
 #ifdef DALI_DT8_SUPPORT_PRIMARY_N
-  case CommandDT8::STORE_TY_PRIMARY_N:
-    if (repeatCount == 0) {
-      return Status::REPEAT_REQUIRED;
-    }
-    return getQueryStoreControllerDT8()->storePrimaryTY();
+  static Status storePrimaryTY(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->getQueryStoreControllerDT8()->storePrimaryTY();
+  }
 
-  case CommandDT8::STORE_XY_COORDINATE_PRIMARY_N:
-    if (repeatCount == 0) {
-      return Status::REPEAT_REQUIRED;
-    }
-    return getQueryStoreControllerDT8()->storePrimaryCoordinate();
+  static Status storePrimaryCoordinate(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->getQueryStoreControllerDT8()->storePrimaryCoordinate();
+  }
 #endif // DALI_DT8_SUPPORT_PRIMARY_N
 
 #ifdef DALI_DT8_SUPPORT_TC
-  case CommandDT8::STORE_COLOUR_TEMPERATURE_LIMIT:
-    if (repeatCount == 0) {
-      return Status::REPEAT_REQUIRED;
-    }
-    return getQueryStoreControllerDT8()->storeColourTemperatureLimit();
+  static Status storeColourTemperatureLimit(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->getQueryStoreControllerDT8()->storeColourTemperatureLimit();
+  }
 #endif // DALI_DT8_SUPPORT_TC
 
-  case CommandDT8::STORE_GEAR_FEATURES_STATUS:
-    if (repeatCount == 0) {
-      return Status::REPEAT_REQUIRED;
-    }
-    return getQueryStoreControllerDT8()->storeGearFeatures();
+  static Status storeGearFeatures(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->getQueryStoreControllerDT8()->storeGearFeatures();
+  }
 
-  case CommandDT8::START_AUTO_CALIBRATION:
-    if (repeatCount == 0) {
-      return Status::REPEAT_REQUIRED;
-    }
+  static Status startAutoCalibration(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
     // TODO Implement in the future
     return Status::INVALID;
+  }
 
-  case CommandDT8::QUERY_GEAR_FEATURES_STATUS:
-    return sendAck(getQueryStoreControllerDT8()->queryGearFeatures());
+  static Status queryGearFeatures(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->sendAck(s->getQueryStoreControllerDT8()->queryGearFeatures());
+  }
 
-  case CommandDT8::QUERY_COLOUR_STATUS:
-    return sendAck(getQueryStoreControllerDT8()->queryColorStatus());
+  static Status queryColorStatus(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->sendAck(s->getQueryStoreControllerDT8()->queryColorStatus());
+  }
 
-  case CommandDT8::QUERY_COLOUR_TYPE_FEATURES:
-    return sendAck(getQueryStoreControllerDT8()->queryColorTypes());
+  static Status queryColorTypes(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->sendAck(s->getQueryStoreControllerDT8()->queryColorTypes());
+  }
 
-  case CommandDT8::QUERY_COLOUR_VALUE: {
-    if (getQueryStoreControllerDT8()->queryColorValue() == Status::OK) {
-      return sendAck(getMemoryController()->getDTR1());
+  static Status queryColorValue(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
+    if (s->getQueryStoreControllerDT8()->queryColorValue() == Status::OK) {
+      return s->sendAck(s->getMemoryController()->getDTR1());
     }
     return Status::INVALID;
   }
 
-  case CommandDT8::QUERY_EXTENDED_VERSION_NUMBER:
-    return sendAck(2);
+  static Status queryExtendedVersionNumber(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
+    return s->sendAck(2);
+  }
 
-  default:
+  static Status unsupported(SlaveDT8* s, uint16_t repeat, Command cmd, uint8_t param) {
     return Status::INVALID;
   }
+};
+
+namespace {
+
+typedef SlaveCommandsDT8::Descriptor Descriptor;
+
+const uint16_t kCommandsFirst = (uint16_t) CommandDT8::SET_TEMPORARY_X_COORDINATE_WORD;
+const uint16_t kCommandsCount = 256 - kCommandsFirst;
+
+constexpr Descriptor command(Status (*handler)(SlaveDT8*, uint16_t, Command, uint8_t), uint8_t flags) {
+  return Descriptor { handler, flags };
+}
+
+#define COMMAND(handler, flags) command(&SlaveCommandsDT8::handler, flags)
+#define ACTION(handler) COMMAND(handler, 0)
+#define CONFIG(handler) COMMAND(handler, kCommandSendTwice)
+#define QUERY(handler) COMMAND(handler, kCommandAnswers)
+#define NONE ACTION(unsupported)
+
+// used at compile time only, Commands is the run time copy
+constexpr Descriptor kCommands[kCommandsCount] = {
+    ACTION(setTemporaryCoordinateX), // 224
+    ACTION(setTemporaryCoordinateY),
+    ACTION(activate),
+#ifdef DALI_DT8_SUPPORT_XY
+    ACTION(coordinateStepUpX),
+    ACTION(coordinateStepDownX),
+    ACTION(coordinateStepUpY),
+    ACTION(coordinateStepDownY),
+#else
+    NONE, NONE, NONE, NONE,
+#endif // DALI_DT8_SUPPORT_XY
+    ACTION(setTemporaryColorTemperature), // 231
+#ifdef DALI_DT8_SUPPORT_TC
+    ACTION(colorTemperatureStepCooler),
+    ACTION(colorTemperatureStepWarmer),
+#else
+    NONE, NONE,
+#endif // DALI_DT8_SUPPORT_TC
+    ACTION(setTemporaryPrimaryLevel), // 234
+    ACTION(setTemporaryRGB),
+    ACTION(setTemporaryWAF),
+    ACTION(setTemporaryRGBWAFControl),
+    ACTION(copyReportToTemporary),
+    NONE, // 239
+#ifdef DALI_DT8_SUPPORT_PRIMARY_N
+    CONFIG(storePrimaryTY), // 240
+    CONFIG(storePrimaryCoordinate),
+#else
+    NONE, NONE,
+#endif // DALI_DT8_SUPPORT_PRIMARY_N
+#ifdef DALI_DT8_SUPPORT_TC
+    CONFIG(storeColourTemperatureLimit), // 242
+#else
+    NONE,
+#endif // DALI_DT8_SUPPORT_TC
+    CONFIG(storeGearFeatures), // 243
+    NONE, // 244
+    NONE, // ASSIGN_COLOUR_TO_LINKED_CHANNEL
+    CONFIG(startAutoCalibration),
+    QUERY(queryGearFeatures), // 247
+    QUERY(queryColorStatus),
+    QUERY(queryColorTypes),
+    QUERY(queryColorValue),
+    NONE, // QUERY_RGBWAF_CONTROL
+    NONE, // QUERY_ASSIGNED_COLOUR
+    NONE, // 253
+    NONE, // 254
+    QUERY(queryExtendedVersionNumber), // 255
+};
+
+#undef NONE
+#undef QUERY
+#undef CONFIG
+#undef ACTION
+#undef COMMAND
+
+typedef CommandTable<SlaveDT8, kCommands, MakeCommandIndexes<kCommandsCount>::Type> Commands;
+
+constexpr Descriptor kUnsupportedCommand = command(&SlaveCommandsDT8::unsupported, 0);
+
+constexpr bool isHandler(CommandDT8 cmd, Status (*handler)(SlaveDT8*, uint16_t, Command, uint8_t)) {
+  return kCommands[(uint16_t) cmd - kCommandsFirst].handler == handler;
+}
+
+static_assert(isHandler(CommandDT8::SET_TEMPORARY_COLOUR_TEMPERATURE, &SlaveCommandsDT8::setTemporaryColorTemperature),
+    "commands table mismatch");
+static_assert(isHandler(CommandDT8::COPY_REPORT_TO_TEMPORARY, &SlaveCommandsDT8::copyReportToTemporary),
+    "commands table mismatch");
+static_assert(isHandler(CommandDT8::STORE_GEAR_FEATURES_STATUS, &SlaveCommandsDT8::storeGearFeatures),
+    "commands table mismatch");
+static_assert(isHandler(CommandDT8::START_AUTO_CALIBRATION, &SlaveCommandsDT8::startAutoCalibration),
+    "commands table mismatch");
+static_assert(isHandler(CommandDT8::QUERY_COLOUR_VALUE, &SlaveCommandsDT8::queryColorValue),
+    "commands table mismatch");
+static_assert(isHandler(CommandDT8::QUERY_EXTENDED_VERSION_NUMBER, &SlaveCommandsDT8::queryExtendedVersionNumber),
+    "commands table mismatch");
+static_assert(kCommands[(uint16_t) CommandDT8::STORE_GEAR_FEATURES_STATUS - kCommandsFirst].is(kCommandSendTwice),
+    "configuration command shall be send twice");
+static_assert(kCommands[(uint16_t) CommandDT8::QUERY_GEAR_FEATURES_STATUS - kCommandsFirst].is(kCommandAnswers),
+    "query command shall answer");
+
+} // namespace
+
+// static
+SlaveCommandsDT8::Descriptor SlaveCommandsDT8::get(Command cmd) {
+  uint16_t index = (uint16_t) cmd - kCommandsFirst;
+  if (index < kCommandsCount) {
+    return Commands::get(index);
+  }
+  return kUnsupportedCommand;
+}
+
+Status SlaveDT8::handleHandleDaliDeviceTypeCommand(uint16_t repeatCount, Command cmd, uint8_t param,
+    uint8_t device_type) {
+  if (device_type != 8) {
+    return Status::INVALID;
+  }
+
+  const SlaveCommandsDT8::Descriptor command = SlaveCommandsDT8::get(cmd);
+  if (command.is(kCommandSendTwice) && (repeatCount == 0)) {
+    return Status::REPEAT_REQUIRED;
+  }
+  return command.handler(this, repeatCount, cmd, param);
 }
 
 } // namespace dali
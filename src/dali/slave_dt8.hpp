@@ -26,11 +26,11 @@ namespace dali {
 
 class SlaveDT8: public Slave {
 public:
-  static Slave* create(IMemory* memoryDriver, ILamp* lampDriver, IBus* busDriver, ITimer* timer);
+  static Slave* create(BusDriver* busDriver, TimerDriver* timer, MemoryDriver* memoryDriver, LampDriver* lampDriver);
 
 protected:
-  SlaveDT8(controller::Memory* memory, controller::Lamp* lamp, controller::QueryStore* queryStore,
-          controller::Bus* busDriver, controller::Initialization* initializationController);
+  SlaveDT8(BusDriver* busDriver, TimerDriver* timer, controller::MemoryDT8* memory, controller::LampDT8* lamp,
+      controller::QueryStoreDT8* queryStore);
 
   Status handleHandleDaliDeviceTypeCommand(uint16_t repeat, Command cmd, uint8_t param, uint8_t device_type) override;
 
@@ -49,6 +49,23 @@ private:
   controller::QueryStoreDT8* getQueryStoreControllerDT8() {
     return (controller::QueryStoreDT8*) getQueryStoreController();
   }
+
+  friend class SlaveCommandsDT8;
+};
+
+// Controllers of the DT8 device, see SlaveStorage
+class SlaveDT8Config {
+public:
+  typedef SlaveDT8 Device;
+
+protected:
+  SlaveDT8Config(MemoryDriver* memoryDriver, LampDriver* lampDriver) :
+      mMemory(memoryDriver, &kDefaultsDT8), mLamp(lampDriver, &mMemory), mQueryStore(&mMemory, &mLamp) {
+  }
+
+  controller::MemoryDT8 mMemory;
+  controller::LampDT8 mLamp;
+  controller::QueryStoreDT8 mQueryStore;
 };
 
 } // namespace dali
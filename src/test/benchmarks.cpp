@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * All right reversed. Usage for commercial on not commercial
+ * purpose without written permission is not allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "benchmarks.hpp"
+
+#ifdef DALI_BENCHMARK
+
+#include "crc16_reference.hpp"
+#include "manchester_reference.hpp"
+
+#include <dali/controller/bus.hpp>
+#include <dali/slave_dt8.hpp>
+#include <util/crc16.hpp>
+#include <util/flash_log.hpp>
+#include <util/manchester.hpp>
+
+#ifdef DALI_TEST
+#include "assert.hpp"
+#include "mocks.hpp"
+#include "tests.hpp"
+#endif // DALI_TEST
+
+namespace dali {
+
+BenchmarkResult gBenchmarkResults[BENCHMARK_MAX_RESULTS];
+uint16_t gBenchmarkResultsCount = 0;
+
+namespace {
+
+#define ITERATIONS 256
+
+GetCycles gGetCycles;
+uint32_t gCyclesMask;
+volatile uint32_t gSink; // prevents optimizing out the measured code
+
+void addResult(const char* name, uint32_t start, uint32_t end, uint32_t operations) {
+  if (gBenchmarkResultsCount < BENCHMARK_MAX_RESULTS) {
+    BenchmarkResult* result = &gBenchmarkResults[gBenchmarkResultsCount++];
+    result->name = name;
+    result->cycles = ((end - start) & gCyclesMask) / operations;
+  }
+}
+
+// Backward frame encoding and forward frame decoding, as done for every frame
+void benchmarkManchester() {
+  uint32_t frames[ITERATIONS];
+  for (uint16_t i = 0; i < ITERATIONS; ++i) {
+    frames[i] = reference::manchesterEncode(i * 257, 16);
+  }
+
+  uint32_t start = gGetCycles();
+  for (uint16_t i = 0; i < ITERATIONS; ++i) {
+    gSink = reference::manchesterDecode(frames[i], 16);
+  }
+  addResult("manchesterDecode32 bitwise", start, gGetCycles(), ITERATIONS);
+
+  start = gGetCycles();
+  for (uint16_t i = 0; i < ITERATIONS; ++i) {
+    gSink = manchesterDecode32(frames[i]);
+  }
+  addResult("manchesterDecode32", start, gGetCycles(), ITERATIONS);
+
+  start = gGetCycles();
+  for (uint16_t i = 0; i < ITERATIONS; ++i) {
+    gSink = reference::manchesterEncodeInv(i, 8);
+  }
+  addResult("manchesterEncode16Inv bitwise", start, gGetCycles(), ITERATIONS);
+
+  start = gGetCycles();
+  for (uint16_t i = 0; i < ITERATIONS; ++i) {
+    gSink = manchesterEncode16Inv(i);
+  }
+  addResult("manchesterEncode16Inv", start, gGetCycles(), ITERATIONS);
+}
+
+// Whole 252 bytes memory image, as checked at boot and by a compaction
+void benchmarkChecksum() {
+  uint8_t image[252];
+  for (uint16_t i = 0; i < sizeof(image); ++i) {
+    image[i] = i * 37 + 11;
+  }
+
+  uint32_t start = gGetCycles();
+  uint8_t sum = 0;
+  for (uint16_t i = 0; i < sizeof(image); ++i) {
+    sum += image[i];
+  }
+  gSink = sum;
+  addResult("checksum 252 bytes additive", start, gGetCycles(), 1);
+
+  start = gGetCycles();
+  gSink = reference::crc16(image, sizeof(image), CRC16_INIT);
+  addResult("crc16 252 bytes bitwise", start, gGetCycles(), 1);
+
+  start = gGetCycles();
+  gSink = crc16(image, sizeof(image));
+  addResult("crc16 252 bytes", start, gGetCycles(), 1);
+}
+
+class NullBusDriver: public IBusDriver {
+public:
+  Status registerClient(IBusClient* c) override { return Status::OK; }
+  Status unregisterClient(IBusClient* c) override { return Status::OK; }
+  Status sendAck(uint8_t ack) override { return Status::OK; }
+  Status setAddressFilter(const AddressFilter& filter) override { return Status::OK; }
+};
+
+class CountingBusClient: public controller::Bus::Client {
+public:
+  Status handleCommand(uint16_t repeat, Command cmd, uint8_t param) override {
+    gSink++;
+    return Status::OK;
+  }
+  Status handleIgnoredCommand(Command cmd, uint8_t param) override { return Status::OK; }
+  void onBusDisconnected() override {}
+};
+
+// Busy bus with 64 devices, only frames addressed to other devices and groups
+void benchmarkBusFilter() {
+  const uint8_t kShortAddr = 5;
+  const uint16_t kGroups = 0x0003;
+
+  uint16_t frames[ITERATIONS];
+  uint32_t random = 1;
+  for (uint16_t i = 0; i < ITERATIONS; ++i) {
+    random = random * 1103515245 + 12345;
+    uint8_t addr = (random >> 16) & 0x3f; // short address
+    if (addr == kShortAddr) {
+      addr = 0x40 + ((random >> 24) & 0x0f); // group address
+      if ((kGroups & (1 << (addr & 0x0f))) != 0) {
+        addr = kShortAddr + 1;
+      }
+    }
+    frames[i] = ((uint16_t) (addr << 1 | (random & 1)) << 8) | ((random >> 8) & 0xff);
+  }
+
+  NullBusDriver driver;
+  CountingBusClient client;
+  controller::Bus bus(&driver, &client);
+  bus.setAddress(kShortAddr << 1 | 1, kGroups);
+
+  uint32_t start = gGetCycles();
+  for (uint16_t i = 0; i < ITERATIONS; ++i) {
+    bus.onDataReceived(i * 25000, frames[i]);
+  }
+  addResult("controller::Bus rejected frame", start, gGetCycles(), ITERATIONS);
+}
+
+#ifdef DALI_TEST
+// Complete path of a frame addressed to us: controller::Bus and command dispatch
+void benchmarkSlaveCommand(BusMock* bus, const char* name, uint16_t data) {
+  uint32_t start = gGetCycles();
+  for (uint16_t i = 0; i < ITERATIONS; ++i) {
+    bus->handleReceivedData(i * 100, data);
+  }
+  addResult(name, start, gGetCycles(), ITERATIONS);
+}
+
+// Configuration command, sent twice within 100ms
+void benchmarkSlaveConfigCommand(BusMock* bus, const char* name, uint16_t data) {
+  uint32_t start = gGetCycles();
+  for (uint16_t i = 0; i < ITERATIONS; ++i) {
+    bus->handleReceivedData(i * 200, data);
+    bus->handleReceivedData(i * 200 + 20, data);
+  }
+  addResult(name, start, gGetCycles(), ITERATIONS);
+}
+
+// Dump of the DT8 data bank, DTR is set back to its start outside the measurement
+void benchmarkSlaveReadMemory(BusMock* bus, const char* name) {
+  const uint16_t kBankSize = DALI_BANK5_ADDR - DALI_BANK4_ADDR;
+  const uint16_t kDtr = ((uint16_t) Command::DATA_TRANSFER_REGISTER - (uint16_t) Command::_SPECIAL_COMMAND) << 8;
+  const uint16_t kDtr1 = ((uint16_t) Command::DATA_TRANSFER_REGISTER_1 - (uint16_t) Command::_SPECIAL_COMMAND) << 8;
+  const uint16_t kRead = 0xff00 | (uint8_t) Command::READ_MEMORY_LOCATION;
+
+  uint64_t timeMs = 0;
+  bus->handleReceivedData(timeMs, kDtr1 | 4);
+  uint32_t cycles = 0;
+  bool answered = true;
+  for (uint16_t i = 0; i < ITERATIONS;) {
+    timeMs += 100;
+    bus->handleReceivedData(timeMs, kDtr | 0);
+    uint32_t start = gGetCycles();
+    for (uint16_t addr = 0; (addr < kBankSize) && (i < ITERATIONS); ++addr, ++i) {
+      timeMs += 100;
+      bus->handleReceivedData(timeMs, kRead);
+      answered &= bus->ack != 0xffff;
+    }
+    cycles += (gGetCycles() - start) & gCyclesMask;
+  }
+  TEST_ASSERT(answered);
+  addResult(name, 0, cycles, ITERATIONS);
+}
+
+// RESET rewrites most of the memory banks
+void benchmarkSlaveReset(CreateSlave createSlave, const char* name) {
+  MemoryMock memory(252);
+  LampMock lamp;
+  BusMock bus;
+  TimerMock timer;
+  Slave* slave = createSlave(&bus, &timer, &memory, &lamp);
+
+  const uint16_t kBroadcast = 0xff00;
+  benchmarkSlaveConfigCommand(&bus, name, kBroadcast | (uint8_t) Command::RESET);
+  delete slave;
+}
+
+void benchmarkSlave() {
+  MemoryMock memory(252);
+  LampMock lamp;
+  BusMock bus;
+  TimerMock timer;
+  Slave* slave = Slave::create(&bus, &timer, &memory, &lamp);
+
+  const uint16_t kBroadcast = 0xff00;
+  benchmarkSlaveCommand(&bus, "Slave OFF", kBroadcast | (uint8_t) Command::OFF);
+  benchmarkSlaveCommand(&bus, "Slave QUERY_STATUS", kBroadcast | (uint8_t) Command::QUERY_STATUS);
+  benchmarkSlaveCommand(&bus, "Slave QUERY_SCENE_F_LEVEL", kBroadcast | (uint8_t) Command::QUERY_SCENE_F_LEVEL);
+  benchmarkSlaveCommand(&bus, "Slave DATA_TRANSFER_REGISTER_2",
+      ((uint16_t) Command::DATA_TRANSFER_REGISTER_2 - (uint16_t) Command::_SPECIAL_COMMAND) << 8);
+
+  benchmarkSlaveReadMemory(&bus, "Slave READ_MEMORY_LOCATION");
+
+  delete slave;
+}
+
+#ifdef DALI_DT8
+// Forward to backward frame latency of a query received right behind ACTIVATE
+// of a new xy colour
+void benchmarkSlaveQueryAfterActivate() {
+  MemoryMock memory(252);
+  LampMock lamp;
+  BusMock bus;
+  TimerMock timer;
+  Slave* slave = SlaveDT8::create(&bus, &timer, &memory, &lamp);
+
+  const uint16_t kBroadcast = 0xff00;
+  const uint16_t kEnableDT8 = (((uint16_t) Command::ENABLE_DEVICE_TYPE_X - (uint16_t) Command::_SPECIAL_COMMAND) << 8) | 8;
+  uint32_t cycles = 0;
+  for (uint16_t i = 0; i < ITERATIONS; ++i) {
+    uint16_t x = (i & 1) ? 22937 : 26214;
+    bus.handleReceivedData(0, (((uint16_t) Command::DATA_TRANSFER_REGISTER - (uint16_t) Command::_SPECIAL_COMMAND) << 8)
+        | (x & 0xff));
+    bus.handleReceivedData(0, (((uint16_t) Command::DATA_TRANSFER_REGISTER_1 - (uint16_t) Command::_SPECIAL_COMMAND) << 8)
+        | (x >> 8));
+    bus.handleReceivedData(0, kEnableDT8);
+    bus.handleReceivedData(0, kBroadcast | (uint8_t) CommandDT8::SET_TEMPORARY_X_COORDINATE_WORD);
+
+    bus.handleReceivedData(0, kEnableDT8);
+    bus.handleReceivedData(0, kBroadcast | (uint8_t) CommandDT8::ACTIVATE);
+
+    uint32_t start = gGetCycles();
+    bus.handleReceivedData(0, kBroadcast | (uint8_t) Command::QUERY_MAX_LEVEL);
+    cycles += (gGetCycles() - start) & gCyclesMask;
+    gSink = bus.ack;
+  }
+  addResult("SlaveDT8 QUERY after ACTIVATE", 0, cycles, ITERATIONS);
+  delete slave;
+}
+#endif // DALI_DT8
+
+// Store of an 8 bytes change on the emulated flash, compactions included
+void benchmarkFlashLog() {
+  NorFlashMock flash(6, 256, 16);
+  uint8_t image[252];
+  util::FlashLog log(&flash, image, sizeof(image));
+  log.load();
+
+  uint32_t start = gGetCycles();
+  for (uint16_t i = 0; i < ITERATIONS; ++i) {
+    uint16_t addr = (i * 8) % (sizeof(image) - 8);
+    image[addr] = i;
+    log.write(addr, 8, true);
+  }
+  addResult("FlashLog write 8 bytes", start, gGetCycles(), ITERATIONS);
+}
+#endif // DALI_TEST
+
+} // namespace
+
+void benchmarks(GetCycles getCycles, uint32_t cyclesMask) {
+  gGetCycles = getCycles;
+  gCyclesMask = cyclesMask;
+  gBenchmarkResultsCount = 0;
+
+  benchmarkManchester();
+  benchmarkBusFilter();
+  benchmarkChecksum();
+#ifdef DALI_TEST
+  benchmarkSlave();
+  benchmarkSlaveReset(Slave::create, "Slave RESET");
+  benchmarkFlashLog();
+#ifdef DALI_DT8
+  benchmarkSlaveReset(SlaveDT8::create, "SlaveDT8 RESET");
+  benchmarkSlaveQueryAfterActivate();
+#endif // DALI_DT8
+#endif // DALI_TEST
+}
+
+} // namespace dali
+
+#endif // DALI_BENCHMARK
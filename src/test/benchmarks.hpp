@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * All right reversed. Usage for commercial on not commercial
+ * purpose without written permission is not allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef DALI_TEST_BENCHMARKS_HPP_
+#define DALI_TEST_BENCHMARKS_HPP_
+
+#ifdef DALI_BENCHMARK
+
+#include <stdint.h>
+
+namespace dali {
+
+// Free running cycle counter, only differences are used
+typedef uint32_t (*GetCycles)();
+
+typedef struct {
+  const char* name;
+  uint32_t cycles; // per operation
+} BenchmarkResult;
+
+#define BENCHMARK_MAX_RESULTS 32
+
+extern BenchmarkResult gBenchmarkResults[BENCHMARK_MAX_RESULTS];
+extern uint16_t gBenchmarkResultsCount;
+
+// Results are collected in gBenchmarkResults (inspect with debugger or print on host)
+// cyclesMask - width of the counter returned by getCycles (ex. 0x00ffffff for SysTick)
+void benchmarks(GetCycles getCycles, uint32_t cyclesMask);
+
+} // namespace dali
+
+#endif // DALI_BENCHMARK
+
+#endif // DALI_TEST_BENCHMARKS_HPP_
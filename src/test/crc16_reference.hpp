@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * All right reversed. Usage for commercial on not commercial
+ * purpose without written permission is not allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef DALI_TEST_CRC16_REFERENCE_HPP_
+#define DALI_TEST_CRC16_REFERENCE_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Bit by bit CRC-16-CCITT used as a reference for the table driven one
+
+namespace dali {
+namespace reference {
+
+inline uint16_t crc16(const uint8_t* data, size_t size, uint16_t crc) {
+  for (size_t i = 0; i < size; ++i) {
+    crc ^= (uint16_t) data[i] << 8;
+    for (uint8_t bit = 0; bit < 8; ++bit) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+    }
+  }
+  return crc;
+}
+
+} // namespace reference
+} // namespace dali
+
+#endif // DALI_TEST_CRC16_REFERENCE_HPP_
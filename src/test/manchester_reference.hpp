@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * All right reversed. Usage for commercial on not commercial
+ * purpose without written permission is not allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef DALI_TEST_MANCHESTER_REFERENCE_HPP_
+#define DALI_TEST_MANCHESTER_REFERENCE_HPP_
+
+#include <stdint.h>
+
+// Bit by bit Manchester codec used as a reference for the table driven one
+
+namespace dali {
+namespace reference {
+
+inline uint32_t manchesterEncode(uint16_t data, uint8_t bits) {
+  uint32_t result = 0xffffffff;
+  uint16_t mask = 1 << (bits - 1);
+  for (uint8_t i = 0; i < bits; ++i) {
+    result <<= 2;
+    if (data & mask) {
+      result |= 1;
+    } else {
+      result |= 2;
+    }
+    data <<= 1;
+  }
+  return result;
+}
+
+inline uint32_t manchesterEncodeInv(uint16_t data, uint8_t bits) {
+  uint32_t result = 0xffffffff;
+  for (uint8_t i = 0; i < bits; ++i) {
+    result <<= 2;
+    if (data & 0x01) {
+      result |= 2;
+    } else {
+      result |= 1;
+    }
+    data >>= 1;
+  }
+  return result;
+}
+
+inline uint16_t manchesterDecode(uint32_t data, uint8_t bits) {
+  uint16_t result = 0x0000;
+  data <<= 32 - bits * 2;
+  for (uint8_t i = 0; i < bits; i++) {
+    switch (data >> 30) {
+    case 1:
+      result <<= 1;
+      result |= 1;
+      data <<= 2;
+      break;
+
+    case 2:
+      result <<= 1;
+      data <<= 2;
+      break;
+
+    default:
+      return 0xffff;
+    }
+  }
+  return result;
+}
+
+} // namespace reference
+} // namespace dali
+
+#endif // DALI_TEST_MANCHESTER_REFERENCE_HPP_
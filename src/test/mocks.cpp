@@ -213,64 +213,36 @@ void LampMock::onLampStateChnaged(ILampState state) {
   }
 }
 
-TimerMock::TimerMock() :
-    time(0) {
-  memset(tasks, 0, sizeof(tasks));
+TimerMock::TimerMock(Time start) :
+    time(start) {
 }
 
-uint64_t TimerMock::getTime() {
+Time TimerMock::getTime() {
   return time;
 }
 
 Status TimerMock::schedule(ITimerTask* task, uint32_t delay, uint32_t period) {
-  for (uint8_t i = 0; i < kMaxTasks; ++i) {
-    TaskInfo* taskInfo = &tasks[i];
-    if (taskInfo->task == nullptr) {
-      taskInfo->task = task;
-      taskInfo->time = time + delay;
-      taskInfo->period = period;
-      return dali::Status::OK;
-    }
-  }
-  return Status::ERROR;
+  tasks.insert(task, time + delay, period);
+  return Status::OK;
 }
 
 void TimerMock::cancel(ITimerTask* task) {
-  for (uint8_t i = 0; i < kMaxTasks; ++i) {
-    TaskInfo* taskInfo = &tasks[i];
-    if (taskInfo->task == task) {
-      taskInfo->task = nullptr;
-    }
-  }
+  tasks.remove(task);
 }
 
 uint32_t TimerMock::randomize() {
   return 0xabdef;
 }
 
-void TimerMock::run(uint64_t now) {
-  uint64_t end = now + time;
-  while (time < end) {
-    uint32_t timeMin = end;
-    for (uint8_t i = 0; i < kMaxTasks; ++i) {
-      TaskInfo* taskInfo = &tasks[i];
-
-      if (taskInfo->task != nullptr) {
-        if (taskInfo->time <= timeMin) {
-          time = timeMin = taskInfo->time;
-        }
-        if (taskInfo->time <= time) {
-          taskInfo->task->timerTaskRun();
-          if (taskInfo->period != 0) {
-            taskInfo->time += taskInfo->period;
-          } else {
-            taskInfo->task = nullptr;
-          }
-        }
-      }
+void TimerMock::run(uint32_t duration) {
+  Time end = time + duration;
+  while (!tasks.isEmpty() && !isTimeBefore(end, tasks.front()->getDeadline())) {
+    if (isTimeBefore(time, tasks.front()->getDeadline())) {
+      time = tasks.front()->getDeadline();
     }
-    time = timeMin;
+    static_cast<ITimerTask*>(tasks.popDue(time))->timerTaskRun();
   }
+  time = end;
 }
 
 BusMock::BusMock() :
@@ -304,10 +276,15 @@ Status BusMock::sendAck(uint8_t ack) {
   return Status::OK;
 }
 
-void BusMock::onDataReceived(uint64_t timeMs, uint16_t data) {
+Status BusMock::setAddressFilter(const AddressFilter& filter) {
+  mAddressFilter = filter;
+  return Status::OK;
+}
+
+void BusMock::onDataReceived(Time timeUs, uint16_t data) {
   for (uint8_t i = 0; i < kMaxClients; ++i) {
     if (mClients[i] != nullptr) {
-      mClients[i]->onDataReceived(timeMs, data);
+      mClients[i]->onDataReceived(timeUs, data);
     }
   }
 }
@@ -325,14 +302,6 @@ void LampControllerListenerMock::onLampStateChnaged(ILamp::ILampState state) {
   capturedState = state;
 }
 
-uint8_t BusControllerListenerMock::getShortAddr() {
-  return addr;
-}
-
-uint16_t BusControllerListenerMock::getGroups() {
-  return groups;
-}
-
 void BusControllerListenerMock::onBusDisconnected() {
 }
 
@@ -357,6 +326,81 @@ void BusControllerListenerMock::reset(uint8_t addr, uint16_t groups) {
   capturedParam = 0xff;
 }
 
+NorFlashMock::NorFlashMock(uint16_t pages, uint16_t pageSize, uint16_t blockSize) :
+    powerCut(kNoPowerCut), powered(true), operations(0), programFailures(0), eraseTimeUs(7000), programTimeUs(100),
+    busyTimeUs(0), mPages(pages), mPageSize(pageSize), mBlockSize(blockSize) {
+  mData = new uint8_t[pages * pageSize];
+  memset(mData, 0xff, pages * pageSize);
+  mEraseCounts = new uint32_t[pages];
+  memset(mEraseCounts, 0, pages * sizeof(uint32_t));
+}
+
+NorFlashMock::~NorFlashMock() {
+  delete[] mData;
+  delete[] mEraseCounts;
+}
+
+const uint8_t* NorFlashMock::page(uint16_t page) {
+  return mData + page * mPageSize;
+}
+
+bool NorFlashMock::erase(uint16_t page) {
+  if (!powered || (page >= mPages)) {
+    return false;
+  }
+  uint8_t* data = mData + page * mPageSize;
+  busyTimeUs += eraseTimeUs;
+  mEraseCounts[page]++;
+  if (isPowerLost()) {
+    // page header survives, the rest is erased
+    memset(data + mPageSize / 2, 0xff, mPageSize / 2);
+    return false;
+  }
+  memset(data, 0xff, mPageSize);
+  return true;
+}
+
+bool NorFlashMock::program(uint16_t page, uint16_t offset, const uint8_t* data, uint16_t size) {
+  if (!powered || (page >= mPages) || (offset % mBlockSize != 0) || (size % mBlockSize != 0)
+      || (offset + size > mPageSize)) {
+    return false;
+  }
+  uint8_t* flash = mData + page * mPageSize + offset;
+  busyTimeUs += programTimeUs * (size / mBlockSize);
+  if (isPowerLost()) {
+    size /= 2; // first half of the data is programmed
+    for (uint16_t i = 0; i < size; ++i) {
+      flash[i] &= data[i];
+    }
+    return false;
+  }
+  if (programFailures > 0) {
+    programFailures--;
+    return false;
+  }
+  for (uint16_t i = 0; i < size; ++i) {
+    flash[i] &= data[i];
+  }
+  return true;
+}
+
+void NorFlashMock::powerOn() {
+  powerCut = kNoPowerCut;
+  powered = true;
+}
+
+bool NorFlashMock::isPowerLost() {
+  operations++;
+  if (powerCut == 0) {
+    powered = false;
+    return true;
+  }
+  if (powerCut != kNoPowerCut) {
+    powerCut--;
+  }
+  return false;
+}
+
 } // namespace dali
 
 #endif // DALI_TEST
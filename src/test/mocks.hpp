@@ -15,6 +15,7 @@
 #include <dali/dali_dt8.hpp>
 #include <dali/controller/bus.hpp>
 #include <dali/controller/lamp.hpp>
+#include <util/flash.hpp>
 
 #include <string.h>
 
@@ -88,7 +89,7 @@ private:
   void onLampStateChnaged(ILampState state);
 };
 
-class BusMock: public IBus {
+class BusMock: public IBusDriver {
 public:
 
   static const uint16_t kMaxClients = 2;
@@ -100,10 +101,14 @@ public:
   Status registerClient(IBusClient* c) override;
   Status unregisterClient(IBusClient* c) override;
   Status sendAck(uint8_t ack) override;
+  Status setAddressFilter(const AddressFilter& filter) override;
 
-  void handleReceivedData(uint64_t timeMs, uint16_t data) {
+  // frame dropped by the address filter like in the receive interrupt
+  void handleReceivedData(Time timeMs, uint16_t data) {
     ack = 0xffff;
-    onDataReceived(timeMs, data);
+    if (mAddressFilter.match(data >> 8)) {
+      onDataReceived(timeMs * 1000, data);
+    }
   }
 
   void setState(IBusState state) {
@@ -115,34 +120,73 @@ public:
 private:
   IBusClient* mClients[kMaxClients];
   IBusState mState;
+  AddressFilter mAddressFilter;
 
-  void onDataReceived(uint64_t timeMs, uint16_t data);
+  void onDataReceived(Time timeUs, uint16_t data);
   void onBusStateChanged(IBusState state);
 };
 
 class TimerMock: public ITimer {
 public:
 
-  static const uint8_t kMaxTasks = 2;
-
-  typedef struct {
-    ITimer::ITimerTask* task;
-    uint64_t time;
-    uint32_t period;
-  } TaskInfo;
-
-  TimerMock();
+  explicit TimerMock(Time start = 0);
   virtual ~TimerMock() {
   }
 
-  uint64_t getTime() override;
+  Time getTime() override;
   Status schedule(ITimerTask* task, uint32_t delay, uint32_t period) override;
   void cancel(ITimerTask* task) override;
   uint32_t randomize() override;
-  void run(uint64_t now);
+  void run(uint32_t duration);
+
+  Time time;
+  util::DeadlineQueue tasks;
+};
+
+// NOR flash: erase sets a page to 0xff, programming can only clear bits.
+// After powerCut more erase/program operations the power is lost: the
+// interrupted operation is done only partially and all later ones fail
+// until powerOn(). Keeps the emulated busy time and the erase count of
+// each page.
+class NorFlashMock: public util::IFlash {
+public:
+  static const uint32_t kNoPowerCut = 0xffffffff;
+
+  NorFlashMock(uint16_t pages, uint16_t pageSize, uint16_t blockSize);
+  virtual ~NorFlashMock();
+
+  uint16_t pageCount() override { return mPages; }
+  uint16_t pageSize() override { return mPageSize; }
+  uint16_t blockSize() override { return mBlockSize; }
+  const uint8_t* page(uint16_t page) override;
+  bool erase(uint16_t page) override;
+  bool program(uint16_t page, uint16_t offset, const uint8_t* data, uint16_t size) override;
+
+  void powerOn();
+  uint32_t getEraseCount(uint16_t page) { return mEraseCounts[page]; }
+
+  // number of operations done before the power is lost
+  uint32_t powerCut;
+  bool powered;
+  uint32_t operations;
+  // number of next program operations failing without changing the data
+  uint32_t programFailures;
+
+  uint32_t eraseTimeUs;
+  uint32_t programTimeUs; // per block
+  uint64_t busyTimeUs;
+
+private:
+  NorFlashMock(const NorFlashMock& other) = delete;
+  NorFlashMock& operator=(const NorFlashMock&) = delete;
+
+  bool isPowerLost();
 
-  uint64_t time;
-  TaskInfo tasks[kMaxTasks];
+  const uint16_t mPages;
+  const uint16_t mPageSize;
+  const uint16_t mBlockSize;
+  uint8_t* mData;
+  uint32_t* mEraseCounts;
 };
 
 class LampControllerListenerMock: public controller::Lamp::Listener {
@@ -152,10 +196,8 @@ public:
   ILamp::ILampState capturedState;
 };
 
-class BusControllerListenerMock: public controller::Bus::Listener {
+class BusControllerListenerMock: public controller::Bus::Client {
 public:
-  uint8_t getShortAddr() override;
-  uint16_t getGroups() override;
   void onBusDisconnected() override;
   Status handleCommand(uint16_t repeat, Command cmd, uint8_t param) override;
   Status handleIgnoredCommand(Command cmd, uint8_t param) override;
@@ -413,7 +413,7 @@ void testPresistenceMemory() {
 
   gSlave->notifyPowerDown();
   delete gSlave; // simulate power off
-  gSlave = gCreateSlave(gMemory, gLamp, gBus, gTimer);
+  gSlave = gCreateSlave(gBus, gTimer, gMemory, gLamp);
   TEST_ASSERT(gSlave != nullptr);
 
   gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::QUERY_GROUPS_L));
@@ -582,12 +582,12 @@ void testStoreDtrAsSysFailureLevel() {
     gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::QUERY_SYS_FAILURE_LEVEL));
     TEST_ASSERT(gBus->ack == sys[i]);
 
-    gBus->setState(IBus::IBusState::DISCONNECTED); // disconnect interface
+    gBus->setState(IBusDriver::IBusState::DISCONNECTED); // disconnect interface
 
     gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::QUERY_ACTUAL_LEVEL));
     TEST_ASSERT(gBus->ack == level[i]);
 
-    gBus->setState(IBus::IBusState::CONNECTED); // disconnect interface
+    gBus->setState(IBusDriver::IBusState::CONNECTED); // disconnect interface
 
     gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::QUERY_ACTUAL_LEVEL));
     TEST_ASSERT(gBus->ack == level[i]);
@@ -617,7 +617,7 @@ void testStoreDtrAsPowerOnLevel() {
 
     gSlave->notifyPowerDown();
     delete gSlave; // simulate power off
-    gSlave = gCreateSlave(gMemory, gLamp, gBus, gTimer);
+    gSlave = gCreateSlave(gBus, gTimer, gMemory, gLamp);
     TEST_ASSERT(gSlave != nullptr);
 
     gSlave->notifyPowerUp();
@@ -956,6 +956,80 @@ void testMemoryBank1() {
   TEST_ASSERT(checksum == 0);
 }
 
+void testMemoryBank1NoReply() {
+  gBus->handleReceivedData(gTimer->time, genData(Command::DATA_TRANSFER_REGISTER, 2)); // addr
+  gBus->handleReceivedData(gTimer->time, genData(Command::DATA_TRANSFER_REGISTER_1, 1)); // bank
+
+  gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::ENABLE_WRITE_MEMORY));
+  gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::ENABLE_WRITE_MEMORY));
+
+  gBus->handleReceivedData(gTimer->time, genData(Command::WRITE_MEMORY_LOCATION_NO_REPLY, 0x55));
+  TEST_ASSERT(gBus->ack == 0xffff);
+  for (uint8_t i = 3; i < 16; i++) {
+    gBus->handleReceivedData(gTimer->time, genData(Command::WRITE_MEMORY_LOCATION_NO_REPLY, i));
+    TEST_ASSERT(gBus->ack == 0xffff);
+  }
+  // beyond the bank
+  gBus->handleReceivedData(gTimer->time, genData(Command::WRITE_MEMORY_LOCATION, 0x10));
+  TEST_ASSERT(gBus->ack == 0xffff);
+
+  gBus->handleReceivedData(gTimer->time, genData(Command::DATA_TRANSFER_REGISTER, 1)); // addr
+  gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::READ_MEMORY_LOCATION));
+  uint8_t checksum = (uint8_t) gBus->ack;
+  gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::READ_MEMORY_LOCATION));
+  TEST_ASSERT(gBus->ack == 0x55);
+  checksum += (uint8_t) gBus->ack;
+  for (uint8_t i = 3; i < 16; i++) {
+    gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::READ_MEMORY_LOCATION));
+    TEST_ASSERT(gBus->ack == i);
+    checksum += (uint8_t) gBus->ack;
+  }
+  TEST_ASSERT(checksum == 0);
+}
+
+void testMemoryBank2Address() {
+  gBus->handleReceivedData(gTimer->time, genData(Command::DATA_TRANSFER_REGISTER, 2)); // addr
+  gBus->handleReceivedData(gTimer->time, genData(Command::DATA_TRANSFER_REGISTER_1, 2)); // bank
+  gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::READ_MEMORY_LOCATION));
+  TEST_ASSERT(gBus->ack != 0xffff);
+  uint8_t lock = (uint8_t) gBus->ack;
+
+  gBus->handleReceivedData(gTimer->time, genData(Command::DATA_TRANSFER_REGISTER, 2)); // addr
+  gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::ENABLE_WRITE_MEMORY));
+  gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::ENABLE_WRITE_MEMORY));
+  gBus->handleReceivedData(gTimer->time, genData(Command::WRITE_MEMORY_LOCATION, 0x55));
+  TEST_ASSERT(gBus->ack == 0x55);
+
+  // short address 7 and group 3
+  gBus->handleReceivedData(gTimer->time, genData(Command::DATA_TRANSFER_REGISTER, 9)); // addr
+  gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::ENABLE_WRITE_MEMORY));
+  gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::ENABLE_WRITE_MEMORY));
+  gBus->handleReceivedData(gTimer->time, genData(Command::WRITE_MEMORY_LOCATION, (7 << 1) | 1));
+  TEST_ASSERT(gBus->ack == ((7 << 1) | 1));
+  gBus->handleReceivedData(gTimer->time, genData(Command::WRITE_MEMORY_LOCATION_NO_REPLY, 1 << 3));
+
+  gBus->handleReceivedData(gTimer->time, genData(7 << 1, Command::QUERY_CONTROL_GEAR));
+  TEST_ASSERT(gBus->ack == 0xff);
+  gBus->handleReceivedData(gTimer->time, genData(0x80 | (3 << 1), Command::QUERY_CONTROL_GEAR));
+  TEST_ASSERT(gBus->ack == 0xff);
+
+  gBus->handleReceivedData(gTimer->time, genData(Command::DATA_TRANSFER_REGISTER, 9)); // addr
+  gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::ENABLE_WRITE_MEMORY));
+  gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::ENABLE_WRITE_MEMORY));
+  gBus->handleReceivedData(gTimer->time, genData(Command::WRITE_MEMORY_LOCATION, DALI_MASK));
+  gBus->handleReceivedData(gTimer->time, genData(Command::WRITE_MEMORY_LOCATION, 0));
+  gBus->handleReceivedData(gTimer->time, genData(Command::DATA_TRANSFER_REGISTER, 2)); // addr
+  gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::ENABLE_WRITE_MEMORY));
+  gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::ENABLE_WRITE_MEMORY));
+  gBus->handleReceivedData(gTimer->time, genData(Command::WRITE_MEMORY_LOCATION, lock));
+  TEST_ASSERT(gBus->ack == lock);
+
+  gBus->handleReceivedData(gTimer->time, genData(7 << 1, Command::QUERY_CONTROL_GEAR));
+  TEST_ASSERT(gBus->ack == 0xffff);
+  gBus->handleReceivedData(gTimer->time, genData(0x80 | (3 << 1), Command::QUERY_CONTROL_GEAR));
+  TEST_ASSERT(gBus->ack == 0xffff);
+}
+
 void testOtherMemoryBanks() {
   // TODO write tests
 }
@@ -1349,7 +1423,7 @@ void testRandomizeResetValues() {
 
   gSlave->notifyPowerDown();
   delete gSlave; // simulate power off
-  gSlave = gCreateSlave(gMemory, gLamp, gBus, gTimer);
+  gSlave = gCreateSlave(gBus, gTimer, gMemory, gLamp);
   TEST_ASSERT(gSlave != nullptr);
 
   gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::QUERY_RANDOM_ADDR_H));
@@ -1746,7 +1820,7 @@ void testSearchAddrReset() {
 
 /////////////////////////////////////////////////////////////////
 void apiTestConfiguration() {
-  gSlave = gCreateSlave(gMemory, gLamp, gBus, gTimer);
+  gSlave = gCreateSlave(gBus, gTimer, gMemory, gLamp);
   TEST_ASSERT(gSlave != nullptr);
 
   testReset();
@@ -1770,6 +1844,8 @@ void apiTestConfiguration() {
   testStoreDtrAsShortAddr();
   testMemoryBank0();
   testMemoryBank1();
+  testMemoryBank1NoReply();
+  testMemoryBank2Address();
   testOtherMemoryBanks();
   testEnableWriteMemory();
 
@@ -1786,7 +1862,7 @@ void apiTestQuery() {
 }
 
 void apiTestInitialization() {
-  gSlave = gCreateSlave(gMemory, gLamp, gBus, gTimer);
+  gSlave = gCreateSlave(gBus, gTimer, gMemory, gLamp);
   TEST_ASSERT(gSlave != nullptr);
 
   testPhisicalAddressAllocation();
@@ -1811,7 +1887,7 @@ void apiTestInitialization() {
 }
 
 //void apiTestMagicPassword() {
-//  gSlave = gCreateSlave(gMemory, gLamp, gBus, gTimer);
+//  gSlave = gCreateSlave(gBus, gTimer, gMemory, gLamp);
 //  TEST_ASSERT(gSlave != nullptr);
 //
 //  gBus->handleReceivedData(gTimer->time, genData(Command::DATA_TRANSFER_REGISTER, 0)); // addr
@@ -1854,9 +1930,35 @@ void apiTestInitialization() {
 //  delete gSlave; // simulate power off
 //}
 
+uint8_t bankChecksum(const MemoryMock& memory, uintptr_t bankAddr) {
+  const uint8_t* bankData = memory.mData + bankAddr;
+  uint8_t checksum = 0;
+  for (uint16_t i = 1; i <= bankData[0]; ++i) {
+    checksum += bankData[i];
+  }
+  return checksum;
+}
+
+void testMemoryWriteTransaction() {
+  MemoryMock memory(252);
+  controller::Memory controller(&memory);
+  TEST_ASSERT(bankChecksum(memory, DALI_BANK2_ADDR) == 0);
+
+  controller.setMaxLevel(200);
+  controller.setLevelForScene(3, 100);
+  controller.setGroups(0x1234);
+  TEST_ASSERT(bankChecksum(memory, DALI_BANK2_ADDR) == 0);
+
+  TEST_ASSERT(controller.reset() == Status::OK);
+  TEST_ASSERT(controller.isReset());
+  TEST_ASSERT(bankChecksum(memory, DALI_BANK2_ADDR) == 0);
+}
+
 } // namespace
 
 void unitTests() {
+  unitTestsUtil();
+  testMemoryWriteTransaction();
 //  controller::Memory::unitTest();
 //  controller::Lamp::unitTest();
 //  controller::QueryStore::unitTest();
@@ -1870,7 +1972,7 @@ void apiTests(CreateSlave createSlave) {
   gMemory = new MemoryMock(252);
   gLamp = new LampMock();
   gBus = new BusMock();
-  gTimer = new TimerMock();
+  gTimer = new TimerMock(kApiTestTimeStart);
 
   apiTestConfiguration();
   apiTestInitialization();
@@ -18,9 +18,23 @@
 
 namespace dali {
 
-typedef Slave* (*CreateSlave)(IMemory* memoryDriver, ILamp* lampDriver, IBus* busDriver, ITimer* timer);
+typedef Slave* (*CreateSlave)(IBusDriver* busDriver, ITimer* timer, IMemory* memoryDriver, ILamp* lampDriver);
+
+// Recovery after the power cuts of the persistence test, in emulated flash time
+typedef struct {
+  uint32_t count;
+  uint32_t maxUs;
+  uint64_t totalUs;
+  uint32_t histogram[8]; // recovered within 1, 2, 4 ... 64 ms and longer
+} RecoveryStats;
+
+extern RecoveryStats gRecoveryStats;
+
+// the mock time of the api tests wraps around after 30 minutes
+const Time kApiTestTimeStart = 0xffffffff - 1000 * 60 * 30;
 
 void unitTests();
+void unitTestsUtil();
 void apiTests(CreateSlave createSlave);
 
 } // namespace dali
@@ -5351,7 +5351,7 @@ void testPowerOnBehaviour_xy() {
 
   gSlave->notifyPowerDown();
   delete gSlave; // Simulate power off
-  gSlave = gCreateSlave(gMemory, gLamp, gBus, gTimer); // simulate power on
+  gSlave = gCreateSlave(gBus, gTimer, gMemory, gLamp); // simulate power on
   TEST_ASSERT(gSlave != nullptr);
   gSlave->notifyPowerUp();
 
@@ -5417,7 +5417,7 @@ void testPowerOnBehaviourMask_xy() {
 
   gSlave->notifyPowerDown();
   delete gSlave; // Simulate power off
-  gSlave = gCreateSlave(gMemory, gLamp, gBus, gTimer); // simulate power on
+  gSlave = gCreateSlave(gBus, gTimer, gMemory, gLamp); // simulate power on
   TEST_ASSERT(gSlave != nullptr);
   gSlave->notifyPowerUp();
 
@@ -5483,7 +5483,7 @@ void testPowerOnBehaviour_Tc() {
 
   gSlave->notifyPowerDown();
   delete gSlave; // Simulate power off
-  gSlave = gCreateSlave(gMemory, gLamp, gBus, gTimer); // simulate power on
+  gSlave = gCreateSlave(gBus, gTimer, gMemory, gLamp); // simulate power on
   TEST_ASSERT(gSlave != nullptr);
   gSlave->notifyPowerUp();
 
@@ -5550,7 +5550,7 @@ void testPowerOnBehaviourMask_Tc() {
 
   gSlave->notifyPowerDown();
   delete gSlave; // Simulate power off
-  gSlave = gCreateSlave(gMemory, gLamp, gBus, gTimer); // simulate power on
+  gSlave = gCreateSlave(gBus, gTimer, gMemory, gLamp); // simulate power on
   TEST_ASSERT(gSlave != nullptr);
   gSlave->notifyPowerUp();
 
@@ -5619,7 +5619,7 @@ void testPowerOnBehaviour_PrimaryN() {
 
   gSlave->notifyPowerDown();
   delete gSlave; // Simulate power off
-  gSlave = gCreateSlave(gMemory, gLamp, gBus, gTimer); // simulate power on
+  gSlave = gCreateSlave(gBus, gTimer, gMemory, gLamp); // simulate power on
   TEST_ASSERT(gSlave != nullptr);
   gSlave->notifyPowerUp();
 
@@ -5695,7 +5695,7 @@ void testPowerOnBehaviourMask_PrimaryN() {
 
   gSlave->notifyPowerDown();
   delete gSlave; // Simulate power off
-  gSlave = gCreateSlave(gMemory, gLamp, gBus, gTimer); // simulate power on
+  gSlave = gCreateSlave(gBus, gTimer, gMemory, gLamp); // simulate power on
   TEST_ASSERT(gSlave != nullptr);
   gSlave->notifyPowerUp();
 
@@ -5787,7 +5787,7 @@ void testPowerOnBehaviour_RGBWAF() {
 
     gSlave->notifyPowerDown();
     delete gSlave; // Simulate power off
-    gSlave = gCreateSlave(gMemory, gLamp, gBus, gTimer); // simulate power on
+    gSlave = gCreateSlave(gBus, gTimer, gMemory, gLamp); // simulate power on
     TEST_ASSERT(gSlave != nullptr);
     gSlave->notifyPowerUp();
 
@@ -5902,7 +5902,7 @@ void testPowerOnBehaviourMask_RGBWAF() {
 
     gSlave->notifyPowerDown();
     delete gSlave; // Simulate power off
-    gSlave = gCreateSlave(gMemory, gLamp, gBus, gTimer); // simulate power on
+    gSlave = gCreateSlave(gBus, gTimer, gMemory, gLamp); // simulate power on
     TEST_ASSERT(gSlave != nullptr);
     gSlave->notifyPowerUp();
 
@@ -6028,9 +6028,9 @@ void testSystemFailureBehaviour_xy() {
 
   goto_xy_Coordinate(point2_x, point2_y);
 
-  gBus->setState(IBus::IBusState::DISCONNECTED);
+  gBus->setState(IBusDriver::IBusState::DISCONNECTED);
   gTimer->run(1000);
-  gBus->setState(IBus::IBusState::CONNECTED);
+  gBus->setState(IBusDriver::IBusState::CONNECTED);
 
   gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::QUERY_ACTUAL_LEVEL));
   TEST_ASSERT(gBus->ack == storedSFL);
@@ -6092,9 +6092,9 @@ void testSystemFailureBehaviourMask_xy() {
 
   goto_xy_Coordinate(point2_x, point2_y);
 
-  gBus->setState(IBus::IBusState::DISCONNECTED);
+  gBus->setState(IBusDriver::IBusState::DISCONNECTED);
   gTimer->run(1000);
-  gBus->setState(IBus::IBusState::CONNECTED);
+  gBus->setState(IBusDriver::IBusState::CONNECTED);
 
   gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::QUERY_ACTUAL_LEVEL));
   TEST_ASSERT(gBus->ack == storedSFL);
@@ -6155,9 +6155,9 @@ void testSystemFaliureBehaviour_Tc() {
   gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::STORE_DTR_AS_SYS_FAIL_LEVEL));
   gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::STORE_DTR_AS_SYS_FAIL_LEVEL));
 
-  gBus->setState(IBus::IBusState::DISCONNECTED);
+  gBus->setState(IBusDriver::IBusState::DISCONNECTED);
   gTimer->run(1000);
-  gBus->setState(IBus::IBusState::CONNECTED);
+  gBus->setState(IBusDriver::IBusState::CONNECTED);
 
   gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::QUERY_ACTUAL_LEVEL));
   TEST_ASSERT(gBus->ack == storedSFL);
@@ -6221,9 +6221,9 @@ void testSystemFaliureBehaviourMask_Tc() {
   gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::STORE_DTR_AS_SYS_FAIL_LEVEL));
   gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::STORE_DTR_AS_SYS_FAIL_LEVEL));
 
-  gBus->setState(IBus::IBusState::DISCONNECTED);
+  gBus->setState(IBusDriver::IBusState::DISCONNECTED);
   gTimer->run(1000);
-  gBus->setState(IBus::IBusState::CONNECTED);
+  gBus->setState(IBusDriver::IBusState::CONNECTED);
 
   gBus->handleReceivedData(gTimer->time, genData(Command::ENABLE_DEVICE_TYPE_X, 8));
   gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, CommandDT8::QUERY_COLOUR_STATUS));
@@ -6284,9 +6284,9 @@ void testSystemFaliureBehaviour_PrimaryN() {
   gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::STORE_DTR_AS_SYS_FAIL_LEVEL));
   gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::STORE_DTR_AS_SYS_FAIL_LEVEL));
 
-  gBus->setState(IBus::IBusState::DISCONNECTED);
+  gBus->setState(IBusDriver::IBusState::DISCONNECTED);
   gTimer->run(1000);
-  gBus->setState(IBus::IBusState::CONNECTED);
+  gBus->setState(IBusDriver::IBusState::CONNECTED);
 
   gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::QUERY_ACTUAL_LEVEL));
   TEST_ASSERT(gBus->ack == storedSFL);
@@ -6358,9 +6358,9 @@ void testSystemFaliureBehaviourMask_PrimaryN() {
   gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::STORE_DTR_AS_SYS_FAIL_LEVEL));
   gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::STORE_DTR_AS_SYS_FAIL_LEVEL));
 
-  gBus->setState(IBus::IBusState::DISCONNECTED);
+  gBus->setState(IBusDriver::IBusState::DISCONNECTED);
   gTimer->run(1000);
-  gBus->setState(IBus::IBusState::CONNECTED);
+  gBus->setState(IBusDriver::IBusState::CONNECTED);
 
   gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::QUERY_ACTUAL_LEVEL));
   TEST_ASSERT(gBus->ack == storedSFL);
@@ -6453,9 +6453,9 @@ void testSystemFailureBehaviour_RGBWAF() {
     gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::STORE_DTR_AS_SYS_FAIL_LEVEL));
     gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::STORE_DTR_AS_SYS_FAIL_LEVEL));
 
-    gBus->setState(IBus::IBusState::DISCONNECTED);
+    gBus->setState(IBusDriver::IBusState::DISCONNECTED);
     gTimer->run(1000);
-    gBus->setState(IBus::IBusState::CONNECTED);
+    gBus->setState(IBusDriver::IBusState::CONNECTED);
 
     gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::QUERY_ACTUAL_LEVEL));
     TEST_ASSERT(gBus->ack == storedSFL);
@@ -6556,9 +6556,9 @@ void testSystemFailureBehaviourMask_RGBWAF() {
     gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::STORE_DTR_AS_SYS_FAIL_LEVEL));
     gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::STORE_DTR_AS_SYS_FAIL_LEVEL));
 
-    gBus->setState(IBus::IBusState::DISCONNECTED);
+    gBus->setState(IBusDriver::IBusState::DISCONNECTED);
     gTimer->run(1000);
-    gBus->setState(IBus::IBusState::CONNECTED);
+    gBus->setState(IBusDriver::IBusState::CONNECTED);
 
     gBus->handleReceivedData(gTimer->time, genData(DALI_MASK, Command::QUERY_ACTUAL_LEVEL));
     TEST_ASSERT(gBus->ack == storedSFL);
@@ -7070,9 +7070,9 @@ void apiTestsDT8(CreateSlave createSlave) {
   gMemory = new MemoryMock(252);
   gLamp = new LampMock();
   gBus = new BusMock();
-  gTimer = new TimerMock();
+  gTimer = new TimerMock(kApiTestTimeStart);
 
-  gSlave = gCreateSlave(gMemory, gLamp, gBus, gTimer);
+  gSlave = gCreateSlave(gBus, gTimer, gMemory, gLamp);
   TEST_ASSERT(gSlave != nullptr);
 
   gSlave->notifyPowerUp();
@@ -0,0 +1,720 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * All right reversed. Usage for commercial on not commercial
+ * purpose without written permission is not allowed.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifdef DALI_TEST
+
+#include "tests.hpp"
+
+#include "assert.hpp"
+#include "crc16_reference.hpp"
+#include "manchester_reference.hpp"
+#include "mocks.hpp"
+
+#include <dali/controller/memory.hpp>
+#include <util/bus_line.hpp>
+#include <util/crc16.hpp>
+#include <util/event_queue.hpp>
+#include <util/fifo.hpp>
+#include <util/flash_legacy.hpp>
+#include <util/flash_log.hpp>
+#include <util/flash_memory.hpp>
+#include <util/manchester.hpp>
+
+namespace dali {
+
+RecoveryStats gRecoveryStats;
+
+namespace {
+
+void testManchesterEncode() {
+  for (uint32_t i = 0; i <= 0xffff; ++i) {
+    uint16_t data = (uint16_t) i;
+    TEST_ASSERT(manchesterEncode16(data) == reference::manchesterEncode(data, 8));
+    TEST_ASSERT(manchesterEncode32(data) == reference::manchesterEncode(data, 16));
+    TEST_ASSERT(manchesterEncode16Inv(data) == reference::manchesterEncodeInv(data, 8));
+    TEST_ASSERT(manchesterEncode32Inv(data) == reference::manchesterEncodeInv(data, 16));
+  }
+}
+
+void testManchesterDecode16() {
+  for (uint32_t i = 0; i <= 0xffff; ++i) {
+    // upper half shall be ignored
+    TEST_ASSERT(manchesterDecode16(i) == reference::manchesterDecode(i, 8));
+    TEST_ASSERT(manchesterDecode16(i | 0x5a5a0000) == reference::manchesterDecode(i, 8));
+  }
+}
+
+void testManchesterDecode32() {
+  for (uint32_t i = 0; i <= 0xffff; ++i) {
+    uint32_t data = reference::manchesterEncode(i, 16);
+    TEST_ASSERT(manchesterDecode32(data) == i);
+  }
+  // every byte lane gets all symbol combinations, the other lanes stay valid
+  for (uint32_t i = 0; i <= 0xffff; i += 0x0101) {
+    uint32_t valid = reference::manchesterEncode(i, 16);
+    for (uint8_t lane = 0; lane < 4; ++lane) {
+      for (uint32_t symbols = 0; symbols <= 0xff; ++symbols) {
+        uint32_t data = valid & ~(0xffUL << (lane * 8));
+        data |= symbols << (lane * 8);
+        TEST_ASSERT(manchesterDecode32(data) == reference::manchesterDecode(data, 16));
+      }
+    }
+  }
+}
+
+void testCrc16() {
+  const uint8_t kCheck[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+  TEST_ASSERT(crc16(kCheck, sizeof(kCheck)) == 0x29b1);
+
+  uint8_t data[64];
+  for (uint16_t i = 0; i < sizeof(data); ++i) {
+    data[i] = i * 37 + 11;
+  }
+  for (uint16_t size = 0; size <= sizeof(data); ++size) {
+    uint16_t crc = crc16(data, size);
+    TEST_ASSERT(crc == reference::crc16(data, size, CRC16_INIT));
+    // computed in two parts
+    TEST_ASSERT(crc16(data + size / 2, size - size / 2, crc16(data, size / 2)) == crc);
+  }
+}
+
+void testFifo() {
+  util::Fifo<uint16_t, 4> fifo;
+  uint16_t item;
+
+  TEST_ASSERT(fifo.isEmpty());
+  TEST_ASSERT(!fifo.pop(&item));
+
+  // indexes wrap around many times
+  for (uint16_t i = 0; i < 1000; ++i) {
+    TEST_ASSERT(fifo.push(i));
+    TEST_ASSERT(fifo.push(i + 1));
+    TEST_ASSERT(fifo.count() == 2);
+    TEST_ASSERT(fifo.pop(&item) && item == i);
+    TEST_ASSERT(fifo.pop(&item) && item == i + 1);
+    TEST_ASSERT(fifo.isEmpty());
+  }
+  TEST_ASSERT(fifo.getOverflows() == 0);
+  TEST_ASSERT(fifo.getMaxCount() == 2);
+
+  for (uint16_t i = 0; i < 6; ++i) {
+    fifo.push(i);
+  }
+  TEST_ASSERT(fifo.count() == 4);
+  TEST_ASSERT(fifo.getOverflows() == 2);
+  TEST_ASSERT(fifo.getMaxCount() == 4);
+  for (uint16_t i = 0; i < 4; ++i) {
+    TEST_ASSERT(fifo.pop(&item) && item == i);
+  }
+  TEST_ASSERT(!fifo.pop(&item));
+}
+
+void testEventQueue() {
+  util::EventQueue<4> events;
+  const uint8_t kNone = util::EventQueue<4>::kNone;
+
+  TEST_ASSERT(events.isEmpty());
+  TEST_ASSERT(events.take(0) == kNone);
+
+  // merged while pending, the first post counts for the latency
+  events.post(3, 100);
+  events.post(1, 200);
+  events.post(3, 300);
+  events.post(2, 400);
+  TEST_ASSERT(events.take(1000) == 1);
+  // a more urgent event goes first
+  events.post(0, 1100);
+  TEST_ASSERT(events.take(1200) == 0);
+  TEST_ASSERT(events.take(1300) == 2);
+  TEST_ASSERT(events.take(1400) == 3);
+  TEST_ASSERT(events.take(1500) == kNone);
+  TEST_ASSERT(events.isEmpty());
+
+  TEST_ASSERT(events.getMaxDepth() == 3);
+  TEST_ASSERT(events.getMaxLatencyUs(0) == 100);
+  TEST_ASSERT(events.getMaxLatencyUs(1) == 800);
+  TEST_ASSERT(events.getMaxLatencyUs(2) == 900);
+  TEST_ASSERT(events.getMaxLatencyUs(3) == 1300);
+
+  // the time wraps around
+  events.post(3, 0xfffffc00);
+  TEST_ASSERT(events.take(0x400) == 3);
+  TEST_ASSERT(events.getMaxLatencyUs(3) == 0x800);
+}
+
+void testBusLine() {
+  util::BusLine line;
+
+  // quiet bus after the start, the idle work must not wait for an edge
+  line.reset(true, 100);
+  TEST_ASSERT(line.isHigh());
+  TEST_ASSERT(line.getLowTimeMs() == util::BusLine::kHigh);
+
+  // bus low at the start, disconnected since then if no edge comes
+  line.reset(false, 100);
+  TEST_ASSERT(!line.isHigh());
+  TEST_ASSERT(line.getLowTimeMs() == 100);
+  line.onRisingEdge();
+  TEST_ASSERT(line.isHigh());
+
+  line.onFallingEdge(200);
+  TEST_ASSERT(!line.isHigh());
+  TEST_ASSERT(line.getLowTimeMs() == 200);
+  line.onFallingEdge(300);
+  TEST_ASSERT(line.getLowTimeMs() == 300);
+  line.onRisingEdge();
+  TEST_ASSERT(line.isHigh());
+}
+
+const uint16_t kFlashPages = 6;
+const uint16_t kFlashPageSize = 256;
+const uint16_t kFlashBlockSize = 16;
+const uint16_t kImageSize = 252;
+
+// changes up to 24 bytes at a random place
+void changeImage(uint8_t* image, uint32_t* random, uint16_t* addr, uint16_t* size) {
+  *random = *random * 1103515245 + 12345;
+  *size = 1 + (*random >> 16) % 24;
+  *random = *random * 1103515245 + 12345;
+  *addr = (*random >> 16) % (kImageSize - *size + 1);
+  for (uint16_t i = 0; i < *size; ++i) {
+    *random = *random * 1103515245 + 12345;
+    image[*addr + i] = *random >> 16;
+  }
+}
+
+bool isStored(NorFlashMock* flash, const uint8_t* expected) {
+  uint8_t image[kImageSize];
+  util::FlashLog log(flash, image, kImageSize);
+  log.load();
+  return memcmp(image, expected, kImageSize) == 0;
+}
+
+void testFlashLog() {
+  NorFlashMock flash(kFlashPages, kFlashPageSize, kFlashBlockSize);
+  uint8_t image[kImageSize];
+  util::FlashLog log(&flash, image, kImageSize);
+  TEST_ASSERT(!log.load());
+
+  // many times around the ring
+  uint32_t random = 1;
+  uint16_t addr, size;
+  for (uint16_t i = 0; i < 1000; ++i) {
+    changeImage(image, &random, &addr, &size);
+    TEST_ASSERT(log.write(addr, size, true));
+    if (i % 64 == 0) {
+      TEST_ASSERT(isStored(&flash, image));
+    }
+  }
+  TEST_ASSERT(isStored(&flash, image));
+
+  // emergency writes take only erased pages and never compact
+  while (log.eraseFreePage()) {
+  }
+  uint16_t writes = 0;
+  do {
+    changeImage(image, &random, &addr, &size);
+    writes++;
+  } while (log.write(addr, size, false));
+  TEST_ASSERT(writes > 1);
+  TEST_ASSERT(!log.eraseFreePage());
+  TEST_ASSERT(log.compactIfNeeded());
+  TEST_ASSERT(isStored(&flash, image));
+  TEST_ASSERT(log.write(addr, size, false));
+}
+
+void testFlashLogPowerCut() {
+  for (uint32_t cut = 0; cut < 500; ++cut) {
+    NorFlashMock flash(kFlashPages, kFlashPageSize, kFlashBlockSize);
+    uint8_t image[kImageSize];
+    uint8_t stored[kImageSize];
+    util::FlashLog log(&flash, image, kImageSize);
+    log.load();
+    memcpy(stored, image, kImageSize);
+
+    flash.powerCut = cut;
+    uint32_t random = 1;
+    uint16_t addr, size;
+    while (true) {
+      changeImage(image, &random, &addr, &size);
+      if (!log.write(addr, size, true)) {
+        break;
+      }
+      memcpy(stored, image, kImageSize);
+    }
+    flash.powerOn();
+
+    // the interrupted write is either lost or complete
+    uint8_t recovered[kImageSize];
+    util::FlashLog recovery(&flash, recovered, kImageSize);
+    recovery.load();
+    TEST_ASSERT(memcmp(recovered, stored, kImageSize) == 0 || memcmp(recovered, image, kImageSize) == 0);
+
+    for (uint16_t i = 0; i < 32; ++i) {
+      changeImage(recovered, &random, &addr, &size);
+      TEST_ASSERT(recovery.write(addr, size, true));
+    }
+    TEST_ASSERT(isStored(&flash, recovered));
+  }
+}
+
+// Wear of a long run with failing programming, the ring shall wear evenly
+void testFlashLogEndurance() {
+  NorFlashMock flash(kFlashPages, kFlashPageSize, kFlashBlockSize);
+  uint8_t image[kImageSize];
+  util::FlashLog log(&flash, image, kImageSize);
+  log.load();
+
+  uint32_t random = 1;
+  uint16_t addr, size;
+  for (uint32_t i = 0; i < 20000; ++i) {
+    changeImage(image, &random, &addr, &size);
+    if (i % 1000 == 0) {
+      flash.programFailures = 1;
+      TEST_ASSERT(!log.write(addr, size, true));
+    }
+    TEST_ASSERT(log.write(addr, size, true));
+  }
+  TEST_ASSERT(isStored(&flash, image));
+
+  uint32_t minErases = flash.getEraseCount(0);
+  uint32_t maxErases = minErases;
+  for (uint16_t page = 1; page < kFlashPages; ++page) {
+    uint32_t erases = flash.getEraseCount(page);
+    if (erases < minErases) {
+      minErases = erases;
+    }
+    if (erases > maxErases) {
+      maxErases = erases;
+    }
+  }
+  TEST_ASSERT(minErases > 0);
+  TEST_ASSERT(maxErases - minErases <= 1);
+  TEST_ASSERT(flash.busyTimeUs >= (uint64_t) maxErases * flash.eraseTimeUs);
+}
+
+const uint16_t kLegacyPageA = 2;
+const uint16_t kLegacyPageB = 3;
+const uint16_t kLegacyDataSize = kImageSize;
+
+void writeLegacyPage(NorFlashMock* flash, uint16_t page, uint16_t index, const uint8_t* image, bool valid) {
+  uint8_t data[kFlashPageSize];
+  memcpy(data + 4, image, kImageSize);
+  uint16_t checksum = valid ? 0 : 1;
+  for (uint16_t i = 4; i < kFlashPageSize; ++i) {
+    checksum -= data[i];
+  }
+  data[0] = checksum;
+  data[1] = checksum >> 8;
+  data[2] = index;
+  data[3] = index >> 8;
+  flash->program(page, 0, data, kFlashPageSize);
+}
+
+// the xmc memory at boot
+void loadOrImport(NorFlashMock* flash, uint8_t* image) {
+  util::FlashLog log(flash, image, kImageSize);
+  if (!log.load() && util::loadLegacyImage(flash, kLegacyPageA, kLegacyPageB, image, kLegacyDataSize)) {
+    log.checkpoint();
+  }
+}
+
+void testFlashLogLegacyImport() {
+  uint8_t older[kImageSize];
+  uint8_t newer[kImageSize];
+  uint32_t random = 1;
+  uint16_t addr, size;
+  for (uint16_t i = 0; i < 32; ++i) {
+    changeImage(older, &random, &addr, &size);
+    changeImage(newer, &random, &addr, &size);
+  }
+  uint8_t image[kImageSize];
+
+  // the index counts down, the newer page can be any of them
+  for (uint16_t newerPage = kLegacyPageA; newerPage <= kLegacyPageB; ++newerPage) {
+    NorFlashMock flash(kFlashPages, kFlashPageSize, kFlashBlockSize);
+    writeLegacyPage(&flash, newerPage, 0xfff0, newer, true);
+    writeLegacyPage(&flash, kLegacyPageA + kLegacyPageB - newerPage, 0xfff1, older, true);
+    loadOrImport(&flash, image);
+    TEST_ASSERT(memcmp(image, newer, kLegacyDataSize) == 0);
+
+    util::FlashLog log(&flash, image, kImageSize);
+    TEST_ASSERT(log.load());
+    TEST_ASSERT(memcmp(image, newer, kLegacyDataSize) == 0);
+  }
+
+  // the page with a wrong checksum is skipped
+  {
+    NorFlashMock flash(kFlashPages, kFlashPageSize, kFlashBlockSize);
+    writeLegacyPage(&flash, kLegacyPageA, 0xfff0, newer, false);
+    writeLegacyPage(&flash, kLegacyPageB, 0xfff1, older, true);
+    TEST_ASSERT(util::loadLegacyImage(&flash, kLegacyPageA, kLegacyPageB, image, kLegacyDataSize));
+    TEST_ASSERT(memcmp(image, older, kLegacyDataSize) == 0);
+  }
+
+  // nothing to import
+  {
+    NorFlashMock flash(kFlashPages, kFlashPageSize, kFlashBlockSize);
+    writeLegacyPage(&flash, kLegacyPageA, 0xfff0, newer, false);
+    TEST_ASSERT(!util::loadLegacyImage(&flash, kLegacyPageA, kLegacyPageB, image, kLegacyDataSize));
+  }
+
+  // an import interrupted by a power cut is repeated at the next boot
+  for (uint32_t cut = 0; cut < 16; ++cut) {
+    NorFlashMock flash(kFlashPages, kFlashPageSize, kFlashBlockSize);
+    writeLegacyPage(&flash, kLegacyPageA, 0xfff0, newer, true);
+    flash.powerCut = cut;
+    loadOrImport(&flash, image);
+    flash.powerOn();
+
+    loadOrImport(&flash, image);
+    TEST_ASSERT(memcmp(image, newer, kLegacyDataSize) == 0);
+    util::FlashLog log(&flash, image, kImageSize);
+    TEST_ASSERT(log.load());
+    TEST_ASSERT(memcmp(image, newer, kLegacyDataSize) == 0);
+  }
+}
+
+// random configuration change, as done by the DALI commands
+Status changeConfiguration(controller::Memory* memory, uint32_t* random) {
+  *random = *random * 1103515245 + 12345;
+  uint8_t value = *random >> 16;
+  switch ((*random >> 24) % 8) {
+  case 0:
+    return memory->setFadeTime(value % (DALI_FADE_TIME_MAX + 1));
+  case 1:
+    return memory->setFadeRate(DALI_FADE_RATE_MIN + value % DALI_FADE_RATE_MAX);
+  case 2:
+    return memory->setLevelForScene(value % (DALI_SCENE_MAX + 1), value);
+  case 3:
+    return memory->setGroups(*random >> 8);
+  case 4:
+    return memory->setShortAddr((value % (DALI_ADDR_MAX + 1)) << 1);
+  case 5:
+    return memory->setRandomAddr(*random);
+  case 6:
+    return memory->setActualLevel(value);
+  default:
+    return (value < 16) ? memory->reset() : memory->setPowerOnLevel(value);
+  }
+}
+
+void addRecovery(uint32_t us) {
+  gRecoveryStats.count++;
+  gRecoveryStats.totalUs += us;
+  if (us > gRecoveryStats.maxUs) {
+    gRecoveryStats.maxUs = us;
+  }
+  uint8_t bucket = 0;
+  while ((bucket < 7) && (us >= (1000UL << bucket))) {
+    bucket++;
+  }
+  gRecoveryStats.histogram[bucket]++;
+}
+
+// pages of another flash, to lose the power of the log and emergency pages at once
+class FlashPages: public util::IFlash {
+public:
+  FlashPages(util::IFlash* flash, uint16_t first, uint16_t pages) :
+      mFlash(flash), mFirst(first), mPages(pages) {
+  }
+
+  uint16_t pageCount() override { return mPages; }
+  uint16_t pageSize() override { return mFlash->pageSize(); }
+  uint16_t blockSize() override { return mFlash->blockSize(); }
+
+  const uint8_t* page(uint16_t page) override {
+    return mFlash->page(mFirst + page);
+  }
+
+  bool erase(uint16_t page) override {
+    return (page < mPages) && mFlash->erase(mFirst + page);
+  }
+
+  bool program(uint16_t page, uint16_t offset, const uint8_t* data, uint16_t size) override {
+    return (page < mPages) && mFlash->program(mFirst + page, offset, data, size);
+  }
+
+private:
+  util::IFlash* const mFlash;
+  const uint16_t mFirst;
+  const uint16_t mPages;
+};
+
+const uint16_t kMemorySize = 252;
+const uint16_t kMemoryTempSize = 32;
+const uint16_t kMemoryTempAddr = kMemorySize - kMemoryTempSize;
+const uint32_t kMemoryQuietMs = 2000;
+const uint32_t kMemoryMinIntervalMs = 10000;
+
+const util::FlashMemory::Config kFlashMemoryConfig = {
+    kMemorySize, kMemoryTempAddr, sizeof(controller::Memory::Temp), 2,
+    kMemoryQuietMs, kMemoryMinIntervalMs, kLegacyPageA, kLegacyPageB };
+
+uint32_t gTimeMs;
+
+uint32_t getTimeMs() {
+  return gTimeMs;
+}
+
+// the xmc memory driver over the log pages and the emergency page
+class FlashMemoryDriver: public IMemory {
+public:
+  explicit FlashMemoryDriver(NorFlashMock* flash) :
+      mFlash(flash), mLogPages(flash, 0, kFlashPages), mEmergencyPage(flash, kFlashPages, 1),
+      mMemory(&mLogPages, &mEmergencyPage, mImage, &kFlashMemoryConfig, getTimeMs) {
+    memset(mImage, 0xff, sizeof(mImage));
+    mMemory.initialize();
+  }
+  virtual ~FlashMemoryDriver() {
+  }
+
+  size_t dataSize() override {
+    return kMemorySize;
+  }
+
+  size_t dataWrite(uintptr_t addr, const uint8_t* data, size_t size) override {
+    if (addr + size > kMemorySize) {
+      return 0;
+    }
+    return mMemory.write(addr, data, size, false);
+  }
+
+  const uint8_t* data(uintptr_t addr, size_t size) override {
+    if (addr + size > kMemorySize) {
+      return nullptr;
+    }
+    return mMemory.getData(addr);
+  }
+
+  size_t tempSize() override {
+    return kMemoryTempSize;
+  }
+
+  size_t tempWrite(uintptr_t addr, const uint8_t* data, size_t size) override {
+    if (addr + size > kMemoryTempSize) {
+      return 0;
+    }
+    return mMemory.write(kMemoryTempAddr + addr, data, size, true);
+  }
+
+  const uint8_t* tempData(uintptr_t addr, size_t size) override {
+    if (addr + size > kMemoryTempSize) {
+      return nullptr;
+    }
+    return mMemory.getData(kMemoryTempAddr + addr);
+  }
+
+  // runs the slices while they use the flash, as when the bus is idle
+  void runIdle() {
+    for (uint16_t i = 0; (i < 256) && mFlash->powered; ++i) {
+      uint32_t operations = mFlash->operations;
+      mMemory.runSlice();
+      if (operations == mFlash->operations) {
+        break;
+      }
+    }
+  }
+
+  // quiet period and interval elapsed, all data changes are stored
+  void runQuiet() {
+    gTimeMs += kMemoryQuietMs + kMemoryMinIntervalMs;
+    runIdle();
+  }
+
+  void synchronize() {
+    mMemory.synchronize();
+  }
+
+  const uint8_t* getImage() { return mImage; }
+
+private:
+  FlashMemoryDriver(const FlashMemoryDriver& other) = delete;
+  FlashMemoryDriver& operator=(const FlashMemoryDriver&) = delete;
+
+  NorFlashMock* const mFlash;
+  FlashPages mLogPages;
+  FlashPages mEmergencyPage;
+  util::FlashMemory mMemory;
+  uint8_t mImage[kMemorySize];
+};
+
+// every chunk of the data area holds its stored or its changed value
+bool isChunkwiseStoredOrChanged(const uint8_t* image, const uint8_t* stored, const uint8_t* changed) {
+  for (uint16_t addr = 0; addr < kMemoryTempAddr; addr += util::FlashMemory::kChunkSize) {
+    uint16_t size = util::FlashMemory::kChunkSize;
+    if (addr + size > kMemoryTempAddr) {
+      size = kMemoryTempAddr - addr;
+    }
+    if (memcmp(image + addr, stored + addr, size) != 0 && memcmp(image + addr, changed + addr, size) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Bursts of configuration changes are stored in the background, the last
+// one by a brown-out. Power is lost at every erase and program step in turn.
+void testMemoryPowerCut() {
+  const uint16_t kBursts = 48;
+  const size_t kEmergencySize = sizeof(controller::Memory::Temp);
+
+  memset(&gRecoveryStats, 0, sizeof(gRecoveryStats));
+  for (uint32_t cut = 0; ; ++cut) {
+    NorFlashMock flash(kFlashPages + 1, kFlashPageSize, kFlashBlockSize);
+    gTimeMs = 0xffffffff - 1000 * 60 * 5; // wraps around during the workload
+    FlashMemoryDriver* driver = new FlashMemoryDriver(&flash);
+    controller::Memory* memory = new controller::Memory(driver);
+    driver->runQuiet();
+
+    uint8_t stored[kMemorySize];
+    uint8_t changed[kMemorySize];
+    memcpy(stored, driver->getImage(), kMemorySize);
+    memcpy(changed, stored, kMemorySize);
+    flash.powerCut = cut;
+    uint32_t random = 1;
+    for (uint16_t burst = 0; (burst < kBursts) && flash.powered; ++burst) {
+      memcpy(stored, changed, kMemorySize);
+      for (uint8_t i = 1 + (random >> 16) % 6; i > 0; --i) {
+        TEST_ASSERT(changeConfiguration(memory, &random) == Status::OK);
+      }
+      memcpy(changed, driver->getImage(), kMemorySize);
+      driver->runIdle();
+      if (burst + 1 < kBursts) {
+        driver->runQuiet();
+      } else {
+        driver->synchronize();
+      }
+    }
+    bool brownOut = flash.powered;
+    delete memory;
+    delete driver;
+
+    // reboot, no chunk is lost or torn, the brown-out keeps all changes
+    flash.powerOn();
+    uint64_t bootTimeUs = flash.busyTimeUs;
+    driver = new FlashMemoryDriver(&flash);
+    if (brownOut) {
+      TEST_ASSERT(memcmp(driver->getImage(), changed, kMemoryTempAddr) == 0);
+      TEST_ASSERT(memcmp(driver->getImage() + kMemoryTempAddr, changed + kMemoryTempAddr, kEmergencySize) == 0);
+    } else {
+      TEST_ASSERT(isChunkwiseStoredOrChanged(driver->getImage(), stored, changed));
+    }
+    memory = new controller::Memory(driver);
+    TEST_ASSERT(memory->isValid());
+    driver->runIdle();
+    addRecovery(flash.busyTimeUs - bootTimeUs);
+
+    // further changes are stored again
+    for (uint16_t i = 0; i < 16; ++i) {
+      TEST_ASSERT(changeConfiguration(memory, &random) == Status::OK);
+      driver->runIdle();
+    }
+    driver->runQuiet();
+    memcpy(changed, driver->getImage(), kMemorySize);
+    delete memory;
+    delete driver;
+
+    driver = new FlashMemoryDriver(&flash);
+    TEST_ASSERT(memcmp(driver->getImage(), changed, kMemoryTempAddr) == 0);
+    delete driver;
+
+    if (brownOut) {
+      break; // the workload is done before the cut
+    }
+  }
+  TEST_ASSERT(gRecoveryStats.count > 100);
+}
+
+class StressTask: public ITimer::ITimerTask {
+public:
+  void timerTaskRun() override {
+    // run exactly at the deadline, in order
+    TEST_ASSERT(timer->time == deadline);
+    TEST_ASSERT(!isTimeBefore(timer->time, *lastRun));
+    *lastRun = timer->time;
+    runs++;
+    deadline += period;
+    if (runs == maxRuns) {
+      timer->cancel(this);
+    }
+  }
+
+  TimerMock* timer;
+  Time* lastRun;
+  Time deadline;
+  uint32_t period;
+  uint16_t runs;
+  uint16_t maxRuns; // cancelled by itself after
+};
+
+void testTimerStress() {
+  const uint16_t kTasks = 2000;
+  const uint32_t kDuration = 20000;
+  const Time kStart = 0xffffffff - kDuration / 2; // wraps around in the middle
+  TimerMock timer(kStart);
+  StressTask* tasks = new StressTask[kTasks];
+  Time lastRun = kStart;
+  uint32_t random = 1;
+  for (uint16_t i = 0; i < kTasks; ++i) {
+    random = random * 1103515245 + 12345;
+    StressTask* task = &tasks[i];
+    task->timer = &timer;
+    task->lastRun = &lastRun;
+    uint32_t delay = (random >> 16) % 5000;
+    task->deadline = kStart + delay;
+    task->period = (i % 4 == 0) ? 0 : 1000 + (random >> 8) % 4000;
+    task->runs = 0;
+    task->maxRuns = (i % 3 == 0) ? 2 : 0;
+    TEST_ASSERT(timer.schedule(task, delay, task->period) == Status::OK);
+  }
+  // cancelled before its first run
+  timer.cancel(&tasks[1]);
+
+  while (timeDiff(timer.time, kStart) < kDuration) {
+    timer.run(7);
+  }
+  for (uint16_t i = 0; i < kTasks; ++i) {
+    StressTask* task = &tasks[i];
+    Time first = task->deadline - task->runs * task->period;
+    uint16_t expected = (task->period == 0) ? 1 : timeDiff(timer.time, first) / task->period + 1;
+    if ((task->maxRuns != 0) && (expected > task->maxRuns)) {
+      expected = task->maxRuns;
+    }
+    if (i == 1) {
+      expected = 0;
+    }
+    TEST_ASSERT(task->runs == expected);
+  }
+  delete[] tasks;
+}
+
+} // namespace
+
+void unitTestsUtil() {
+  testManchesterEncode();
+  testManchesterDecode16();
+  testManchesterDecode32();
+  testCrc16();
+  testFifo();
+  testEventQueue();
+  testBusLine();
+  testFlashLog();
+  testFlashLogPowerCut();
+  testFlashLogEndurance();
+  testFlashLogLegacyImport();
+  testMemoryPowerCut();
+  testTimerStress();
+}
+
+} // namespace dali
+
+#endif // DALI_TEST
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * Licensed under GNU General Public License 3.0 or later.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef UTIL_BUS_LINE_HPP_
+#define UTIL_BUS_LINE_HPP_
+
+#include <stdint.h>
+
+namespace util {
+
+// Level of the bus line followed by its edges (ex. in ISR). There is no edge
+// before the first bit, so the level at the start is read from the pin.
+class BusLine {
+public:
+  static const uint32_t kHigh = 0xffffffff;
+
+  BusLine() :
+      mLowTimeMs(kHigh) {
+  }
+
+  void reset(bool high, uint32_t timeMs) {
+    mLowTimeMs = high ? kHigh : timeMs;
+  }
+
+  void onRisingEdge() {
+    mLowTimeMs = kHigh;
+  }
+
+  void onFallingEdge(uint32_t timeMs) {
+    mLowTimeMs = timeMs;
+  }
+
+  bool isHigh() const {
+    return mLowTimeMs == kHigh;
+  }
+
+  // since when the line is low, kHigh when it is high
+  uint32_t getLowTimeMs() const {
+    return mLowTimeMs;
+  }
+
+private:
+  BusLine(const BusLine& other) = delete;
+  BusLine& operator=(const BusLine&) = delete;
+
+  volatile uint32_t mLowTimeMs; // 32-bit, read without masking interrupts
+};
+
+} // namespace util
+
+#endif // UTIL_BUS_LINE_HPP_
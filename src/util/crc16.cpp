@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * Licensed under GNU General Public License 3.0 or later.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "crc16.hpp"
+
+namespace {
+
+// remainders of the polynomial for a nibble, 32 bytes of flash instead of 512
+const uint16_t kCrc16Table[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+    0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef };
+
+} // namespace
+
+uint16_t crc16(const uint8_t* data, size_t size, uint16_t crc) {
+  for (size_t i = 0; i < size; ++i) {
+    uint8_t byte = data[i];
+    crc = (crc << 4) ^ kCrc16Table[(crc >> 12) ^ (byte >> 4)];
+    crc = (crc << 4) ^ kCrc16Table[(crc >> 12) ^ (byte & 0x0f)];
+  }
+  return crc;
+}
@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * Licensed under GNU General Public License 3.0 or later.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef UTIL_CRC16_HPP_
+#define UTIL_CRC16_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CRC16_INIT 0xffff
+
+// CRC-16-CCITT, polynomial 0x1021, MSB first, no final xor.
+// Can be computed in parts by passing the previous result as crc.
+uint16_t crc16(const uint8_t* data, size_t size, uint16_t crc = CRC16_INIT);
+
+#endif // UTIL_CRC16_HPP_
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * Licensed under GNU General Public License 3.0 or later.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "deadline_queue.hpp"
+
+namespace util {
+
+namespace {
+
+bool isAfter(uint32_t a, uint32_t b) {
+  return (int32_t) (a - b) > 0;
+}
+
+} // namespace
+
+void DeadlineQueue::insert(Entry* entry, uint32_t time, uint32_t period) {
+  remove(entry);
+  entry->mTime = time;
+  entry->mPeriod = period;
+  link(entry);
+}
+
+void DeadlineQueue::remove(Entry* entry) {
+  if (!entry->mQueued) {
+    return;
+  }
+  for (Entry** next = &mHead; *next != nullptr; next = &(*next)->mNext) {
+    if (*next == entry) {
+      *next = entry->mNext;
+      break;
+    }
+  }
+  entry->mNext = nullptr;
+  entry->mQueued = false;
+}
+
+DeadlineQueue::Entry* DeadlineQueue::popDue(uint32_t now) {
+  Entry* entry = mHead;
+  if ((entry == nullptr) || isAfter(entry->mTime, now)) {
+    return nullptr;
+  }
+  mHead = entry->mNext;
+  entry->mNext = nullptr;
+  entry->mQueued = false;
+  if (entry->mPeriod != 0) {
+    entry->mTime += entry->mPeriod;
+    link(entry);
+  }
+  return entry;
+}
+
+void DeadlineQueue::link(Entry* entry) {
+  Entry** next = &mHead;
+  while ((*next != nullptr) && !isAfter((*next)->mTime, entry->mTime)) {
+    next = &(*next)->mNext;
+  }
+  entry->mNext = *next;
+  *next = entry;
+  entry->mQueued = true;
+}
+
+} // namespace util
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * Licensed under GNU General Public License 3.0 or later.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef UTIL_DEADLINE_QUEUE_HPP_
+#define UTIL_DEADLINE_QUEUE_HPP_
+
+#include <stdint.h>
+
+namespace util {
+
+// Intrusive list of entries sorted by their deadlines, the earliest first.
+// Entries with the same deadline keep the order of insertion. The next
+// deadline is known at once, an insertion walks the list. Deadlines are
+// compared by their difference, so the time may wrap around as long as
+// all of them are within 2^31 ticks of the current time.
+class DeadlineQueue {
+public:
+  class Entry {
+  public:
+    Entry() :
+        mNext(nullptr), mTime(0), mPeriod(0), mQueued(false) {
+    }
+
+    uint32_t getDeadline() const { return mTime; }
+    bool isQueued() const { return mQueued; }
+
+  private:
+    friend class DeadlineQueue;
+
+    Entry(const Entry& other) = delete;
+    Entry& operator=(const Entry&) = delete;
+
+    Entry* mNext;
+    uint32_t mTime;
+    uint32_t mPeriod;
+    bool mQueued;
+  };
+
+  DeadlineQueue() :
+      mHead(nullptr) {
+  }
+
+  // Queues the entry, an entry already queued is moved to the new deadline
+  void insert(Entry* entry, uint32_t time, uint32_t period);
+  void remove(Entry* entry);
+
+  bool isEmpty() const { return mHead == nullptr; }
+  // the entry with the earliest deadline, nullptr if empty
+  Entry* front() const { return mHead; }
+
+  // Takes the first entry due at the given time. A periodic entry is queued
+  // again one period after its deadline, so delays do not accumulate, and
+  // can be cancelled by its own callback.
+  Entry* popDue(uint32_t now);
+
+private:
+  DeadlineQueue(const DeadlineQueue& other) = delete;
+  DeadlineQueue& operator=(const DeadlineQueue&) = delete;
+
+  void link(Entry* entry);
+
+  Entry* mHead;
+};
+
+} // namespace util
+
+#endif // UTIL_DEADLINE_QUEUE_HPP_
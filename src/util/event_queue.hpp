@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * Licensed under GNU General Public License 3.0 or later.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef UTIL_EVENT_QUEUE_HPP_
+#define UTIL_EVENT_QUEUE_HPP_
+
+#include <stdint.h>
+
+namespace util {
+
+// Pending events taken by priority, the lowest event number first. An event
+// is a flag set by any producer (ex. ISR) and cleared by the consumer (ex.
+// main loop) before the work is done, so posting an event already pending
+// only merges them, no interrupt masking is needed and nothing overflows.
+template<uint8_t kEvents>
+class EventQueue {
+public:
+  static const uint8_t kNone = 0xff;
+
+  EventQueue() :
+      mMaxDepth(0) {
+    for (uint8_t i = 0; i < kEvents; ++i) {
+      mPending[i] = false;
+      mPostTimeUs[i] = 0;
+      mMaxLatencyUs[i] = 0;
+    }
+  }
+
+  // producer side, the time of the first post is kept for the latency
+  void post(uint8_t event, uint32_t timeUs) {
+    if (!mPending[event]) {
+      mPostTimeUs[event] = timeUs;
+      barrier(); // time must be stored before the event is published
+      mPending[event] = true;
+    }
+  }
+
+  // consumer side, the most urgent pending event or kNone
+  uint8_t take(uint32_t timeUs) {
+    uint8_t event = kNone;
+    uint8_t depth = 0;
+    for (uint8_t i = 0; i < kEvents; ++i) {
+      if (mPending[i]) {
+        if (event == kNone) {
+          event = i;
+        }
+        depth++;
+      }
+    }
+    if (event == kNone) {
+      return kNone;
+    }
+    uint32_t latencyUs = timeUs - mPostTimeUs[event];
+    barrier(); // time must be read before a new post can overwrite it
+    mPending[event] = false;
+    if (latencyUs > mMaxLatencyUs[event]) {
+      mMaxLatencyUs[event] = latencyUs;
+    }
+    if (depth > mMaxDepth) {
+      mMaxDepth = depth;
+    }
+    return event;
+  }
+
+  bool isEmpty() const {
+    for (uint8_t i = 0; i < kEvents; ++i) {
+      if (mPending[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // the highest number of events pending at once
+  uint8_t getMaxDepth() const { return mMaxDepth; }
+  // the longest time from the post to the take of the event
+  uint32_t getMaxLatencyUs(uint8_t event) const { return mMaxLatencyUs[event]; }
+
+private:
+  EventQueue(const EventQueue& other) = delete;
+  EventQueue& operator=(const EventQueue&) = delete;
+
+  static void barrier() {
+    __asm volatile ("" ::: "memory");
+  }
+
+  volatile bool mPending[kEvents];
+  volatile uint32_t mPostTimeUs[kEvents];
+  uint32_t mMaxLatencyUs[kEvents];
+  uint8_t mMaxDepth;
+};
+
+} // namespace util
+
+#endif // UTIL_EVENT_QUEUE_HPP_
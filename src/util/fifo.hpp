@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * Licensed under GNU General Public License 3.0 or later.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef UTIL_FIFO_HPP_
+#define UTIL_FIFO_HPP_
+
+#include <stdint.h>
+
+namespace util {
+
+// Lock-free single producer (ex. ISR) / single consumer (ex. main loop) queue.
+// Each index is written only by one side, so no interrupt masking is needed
+// on a single core.
+template<typename T, uint8_t kSize>
+class Fifo {
+public:
+  static_assert((kSize & (kSize - 1)) == 0, "Fifo size must be a power of 2");
+  static_assert(kSize <= 128, "Fifo size must fit uint8_t indexes");
+
+  Fifo() :
+      mHead(0), mTail(0), mOverflows(0), mMaxCount(0) {
+  }
+
+  // producer side
+  bool push(const T& item) {
+    uint8_t head = mHead;
+    uint8_t count = head - mTail;
+    if (count >= kSize) {
+      mOverflows++;
+      return false;
+    }
+    mItems[head & (kSize - 1)] = item;
+    barrier(); // item must be stored before it is published
+    mHead = head + 1;
+    if (count + 1 > mMaxCount) {
+      mMaxCount = count + 1;
+    }
+    return true;
+  }
+
+  // consumer side
+  bool pop(T* item) {
+    uint8_t tail = mTail;
+    if (tail == mHead) {
+      return false;
+    }
+    *item = mItems[tail & (kSize - 1)];
+    barrier(); // item must be read before the slot is released
+    mTail = tail + 1;
+    return true;
+  }
+
+  bool isEmpty() const { return mHead == mTail; }
+  uint8_t count() const { return (uint8_t) (mHead - mTail); }
+
+  // number of items dropped because the queue was full
+  uint32_t getOverflows() const { return mOverflows; }
+  // the highest number of items waiting in the queue
+  uint8_t getMaxCount() const { return mMaxCount; }
+
+private:
+  Fifo(const Fifo& other) = delete;
+  Fifo& operator=(const Fifo&) = delete;
+
+  static void barrier() {
+    __asm volatile ("" ::: "memory");
+  }
+
+  T mItems[kSize];
+  volatile uint8_t mHead;
+  volatile uint8_t mTail;
+  volatile uint32_t mOverflows;
+  volatile uint8_t mMaxCount;
+};
+
+} // namespace util
+
+#endif // UTIL_FIFO_HPP_
@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * Licensed under GNU General Public License 3.0 or later.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef UTIL_FLASH_HPP_
+#define UTIL_FLASH_HPP_
+
+#include <stdint.h>
+
+namespace util {
+
+// NOR flash split in pages. A page is erased to 0xff as a whole and then
+// each block of the page can be programmed once.
+class IFlash {
+public:
+  virtual uint16_t pageCount() = 0;
+  virtual uint16_t pageSize() = 0;
+  virtual uint16_t blockSize() = 0;
+
+  // memory mapped content of the page
+  virtual const uint8_t* page(uint16_t page) = 0;
+  virtual bool erase(uint16_t page) = 0;
+  // offset and size are multiples of the block size
+  virtual bool program(uint16_t page, uint16_t offset, const uint8_t* data, uint16_t size) = 0;
+};
+
+} // namespace util
+
+#endif // UTIL_FLASH_HPP_
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * Licensed under GNU General Public License 3.0 or later.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "flash_legacy.hpp"
+
+#include <string.h>
+
+namespace util {
+namespace {
+
+const uint16_t kMetaDataSize = 4;
+const uint16_t kIndexErased = 0xffff;
+
+uint16_t getIndex(const uint8_t* page) {
+  return page[2] | ((uint16_t) page[3] << 8);
+}
+
+bool isValid(const uint8_t* page, uint16_t pageSize) {
+  if (getIndex(page) == kIndexErased) {
+    return false; // never written
+  }
+  uint16_t checksum = page[0] | ((uint16_t) page[1] << 8);
+  for (uint16_t i = kMetaDataSize; i < pageSize; ++i) {
+    checksum += page[i];
+  }
+  return checksum == 0;
+}
+
+} // namespace
+
+bool loadLegacyImage(IFlash* flash, uint16_t pageA, uint16_t pageB, uint8_t* image, uint16_t size) {
+  const uint16_t pageSize = flash->pageSize();
+  if (size > pageSize - kMetaDataSize) {
+    return false;
+  }
+  const uint8_t* dataA = flash->page(pageA);
+  const uint8_t* dataB = flash->page(pageB);
+  const bool validA = isValid(dataA, pageSize);
+  const bool validB = isValid(dataB, pageSize);
+  const uint8_t* newest;
+  if (validA && (!validB || getIndex(dataA) < getIndex(dataB))) {
+    newest = dataA;
+  } else if (validB) {
+    newest = dataB;
+  } else {
+    return false;
+  }
+  memcpy(image, newest + kMetaDataSize, size);
+  return true;
+}
+
+} // namespace util
@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * Licensed under GNU General Public License 3.0 or later.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef UTIL_FLASH_LEGACY_HPP_
+#define UTIL_FLASH_LEGACY_HPP_
+
+#include "flash.hpp"
+
+namespace util {
+
+// Image stored by the firmware before the flash log, in one of two pages.
+// The page starts with a metadata word: additive checksum of the page in the
+// low half and the index counting down from 0xffff on each write in the high
+// half, the image follows.
+// Copies the first size bytes of the newest valid image, returns false if
+// there is none.
+bool loadLegacyImage(IFlash* flash, uint16_t pageA, uint16_t pageB, uint8_t* image, uint16_t size);
+
+} // namespace util
+
+#endif // UTIL_FLASH_LEGACY_HPP_
@@ -0,0 +1,358 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * Licensed under GNU General Public License 3.0 or later.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "flash_log.hpp"
+
+#include "crc16.hpp"
+
+#include <string.h>
+
+namespace util {
+namespace {
+
+const uint16_t kPageMagic = 0x474c;
+const uint8_t kRecordCheckpoint = 0x01;
+
+bool isErased(const uint8_t* data, uint16_t size) {
+  for (uint16_t i = 0; i < size; ++i) {
+    if (data[i] != 0xff) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+FlashLog::FlashLog(IFlash* flash, uint8_t* image, uint16_t imageSize) :
+    mFlash(flash), mImage(image), mImageSize(imageSize), mPages(flash->pageCount() < kMaxPages ? flash->pageCount() : kMaxPages),
+    mPageSize(flash->pageSize()), mBlockSize(flash->blockSize()), mHeadPage(kNoPage), mHeadOffset(0),
+    mTailPage(kNoPage), mPageSequence(0), mRecordSequence(0), mValidPages(0) {
+  // the first block of each page holds the page header
+  mMaxRecordSize = mPageSize - mBlockSize - sizeof(RecordHeader);
+  if (mMaxRecordSize > 0xff) {
+    mMaxRecordSize = 0xff;
+  }
+
+  // pages needed by a checkpoint
+  mCheckpointPages = 1;
+  uint16_t used = mBlockSize;
+  for (uint16_t addr = 0; addr < mImageSize; addr += mMaxRecordSize) {
+    uint16_t size = mImageSize - addr < mMaxRecordSize ? mImageSize - addr : mMaxRecordSize;
+    if (used + recordBytes(size) > mPageSize) {
+      mCheckpointPages++;
+      used = mBlockSize;
+    }
+    used += recordBytes(size);
+  }
+}
+
+bool FlashLog::load() {
+  memset(mImage, 0xff, mImageSize);
+  mHeadPage = kNoPage;
+  mHeadOffset = 0;
+  mTailPage = kNoPage;
+  mPageSequence = 0;
+  mRecordSequence = 0;
+
+  // headers are checked once, the newest one tells where the replay starts
+  mValidPages = 0;
+  uint16_t newestPage = kNoPage;
+  for (uint16_t page = 0; page < mPages; ++page) {
+    if (isPageValid(page)) {
+      mValidPages |= 1UL << page;
+      if ((newestPage == kNoPage) || (getSequence(page) > getSequence(newestPage))) {
+        newestPage = page;
+      }
+    }
+  }
+  if (newestPage == kNoPage) {
+    return false;
+  }
+  const uint32_t tailSequence = ((const PageHeader*) mFlash->page(newestPage))->tailSequence;
+
+  uint16_t checkpointPage = kNoPage;
+  uint16_t checkpointOffset = 0;
+  uint16_t unusedPage = kNoPage;
+  bool stored = false;
+  for (uint16_t page = findPage(tailSequence - 1); page != kNoPage; page = findPage(mPageSequence)) {
+    if (mTailPage == kNoPage) {
+      mTailPage = page; // used until a checkpoint is found
+    }
+    mHeadPage = page;
+    mPageSequence = getSequence(page);
+    if (replayPage(page, &checkpointPage, &checkpointOffset)) {
+      unusedPage = kNoPage;
+      stored = true;
+    } else if (unusedPage == kNoPage) {
+      unusedPage = page;
+    }
+  }
+  if (!stored) {
+    // the ring starts again from the first page, above the sequence found
+    mHeadPage = kNoPage;
+    mHeadOffset = 0;
+    mTailPage = kNoPage;
+    return false;
+  }
+  if ((unusedPage != kNoPage) && (unusedPage != mTailPage)) {
+    // trailing pages without new data (e.g. an interrupted checkpoint) are reused
+    mHeadPage = (unusedPage + mPages - 1) % mPages;
+    mHeadOffset = mPageSize;
+  }
+  return true;
+}
+
+bool FlashLog::write(uint16_t addr, uint16_t size, bool mayErase) {
+  if (addr + size > mImageSize) {
+    return false;
+  }
+  while (size > 0) {
+    uint16_t recordSize = size < mMaxRecordSize ? size : mMaxRecordSize;
+    if (!fits(recordSize) && isFull()) {
+      // remaining pages are reserved for a checkpoint, which stores this write too
+      return mayErase ? checkpoint() : false;
+    }
+    if (!append(addr, recordSize, 0, mayErase)) {
+      return false;
+    }
+    addr += recordSize;
+    size -= recordSize;
+  }
+  return true;
+}
+
+bool FlashLog::compactIfNeeded() {
+  if (isFull()) {
+    return checkpoint();
+  }
+  return true;
+}
+
+bool FlashLog::eraseFreePage() {
+  uint16_t page = mHeadPage == kNoPage ? 0 : (mHeadPage + 1) % mPages;
+  for (uint16_t i = getFreePages(); i > 0; --i, page = (page + 1) % mPages) {
+    if (!isErased(mFlash->page(page), mPageSize)) {
+      mFlash->erase(page);
+      return true;
+    }
+  }
+  return false;
+}
+
+void FlashLog::format() {
+  for (uint16_t page = 0; page < mPages; ++page) {
+    mFlash->erase(page);
+  }
+  mHeadPage = kNoPage;
+  mHeadOffset = 0;
+  mTailPage = kNoPage;
+}
+
+uint16_t FlashLog::getFreePages() {
+  if (mHeadPage == kNoPage) {
+    return mPages;
+  }
+  return mPages - 1 - (mHeadPage + mPages - mTailPage) % mPages;
+}
+
+bool FlashLog::checkpoint() {
+  if (getFreePages() < mCheckpointPages) {
+    return false;
+  }
+  const uint16_t previousPage = mHeadPage;
+  mHeadOffset = mPageSize; // start from a new page
+  uint16_t firstPage = kNoPage;
+  for (uint16_t addr = 0; addr < mImageSize; addr += mMaxRecordSize) {
+    uint16_t size = mImageSize - addr < mMaxRecordSize ? mImageSize - addr : mMaxRecordSize;
+    if (!append(addr, size, kRecordCheckpoint, true)) {
+      mHeadPage = previousPage; // pages of the interrupted checkpoint are reused
+      return false;
+    }
+    if (firstPage == kNoPage) {
+      firstPage = mHeadPage;
+    }
+  }
+  mTailPage = firstPage;
+  return true;
+}
+
+bool FlashLog::append(uint16_t addr, uint16_t size, uint8_t flags, bool mayErase) {
+  if (!fits(size) && !openPage(mayErase)) {
+    return false;
+  }
+
+  RecordHeader header;
+  header.sequence = mRecordSequence;
+  header.addr = addr;
+  header.size = size;
+  header.flags = flags;
+  header.crc = crc16((const uint8_t*) &header.sequence, sizeof(header) - sizeof(header.crc));
+  header.crc = crc16(mImage + addr, size, header.crc);
+
+  // header is programmed first, an interrupted record fails its CRC
+  const uint16_t bytes = recordBytes(size);
+  const uint16_t total = sizeof(header) + size;
+  uint8_t block[kMaxBlockSize];
+  uint16_t pos = 0;
+  for (uint16_t offset = 0; offset < bytes; offset += mBlockSize) {
+    for (uint16_t i = 0; i < mBlockSize; ++i, ++pos) {
+      if (pos < sizeof(header)) {
+        block[i] = ((const uint8_t*) &header)[pos];
+      } else if (pos < total) {
+        block[i] = mImage[addr + pos - sizeof(header)];
+      } else {
+        block[i] = 0xff;
+      }
+    }
+    if (!mFlash->program(mHeadPage, mHeadOffset + offset, block, mBlockSize)) {
+      mHeadOffset = mPageSize; // the page can't be used any more
+      return false;
+    }
+  }
+  mHeadOffset += bytes;
+  mRecordSequence++;
+  return true;
+}
+
+bool FlashLog::fits(uint16_t size) {
+  return (mHeadPage != kNoPage) && (mHeadOffset + recordBytes(size) <= mPageSize);
+}
+
+bool FlashLog::openPage(bool mayErase) {
+  uint16_t page = 0;
+  if (mHeadPage != kNoPage) {
+    page = (mHeadPage + 1) % mPages;
+    if (page == mTailPage) {
+      return false; // ring is full
+    }
+  }
+  if (!isErased(mFlash->page(page), mPageSize) && (!mayErase || !mFlash->erase(page))) {
+    return false;
+  }
+
+  PageHeader header;
+  header.sequence = mPageSequence + 1;
+  header.tailSequence = mTailPage == kNoPage ? header.sequence : getSequence(mTailPage);
+  header.magic = kPageMagic;
+  header.crc = crc16((const uint8_t*) &header, sizeof(header) - sizeof(header.crc));
+  uint8_t block[kMaxBlockSize];
+  memset(block, 0xff, mBlockSize);
+  memcpy(block, &header, sizeof(header));
+  if (!mFlash->program(page, 0, block, mBlockSize)) {
+    return false;
+  }
+
+  mPageSequence++;
+  if (mTailPage == kNoPage) {
+    mTailPage = page;
+  }
+  mHeadPage = page;
+  mHeadOffset = mBlockSize;
+  return true;
+}
+
+bool FlashLog::isPageValid(uint16_t page) {
+  const PageHeader* header = (const PageHeader*) mFlash->page(page);
+  return (header->magic == kPageMagic) && (header->sequence != 0xffffffff)
+      && (header->crc == crc16((const uint8_t*) header, sizeof(PageHeader) - sizeof(header->crc)));
+}
+
+// returns the valid page with the lowest sequence above the given one
+uint16_t FlashLog::findPage(uint32_t previousSequence) {
+  uint16_t result = kNoPage;
+  uint32_t resultSequence = 0xffffffff;
+  for (uint16_t page = 0; page < mPages; ++page) {
+    if ((mValidPages & (1UL << page)) == 0) {
+      continue;
+    }
+    uint32_t sequence = getSequence(page);
+    if ((sequence > previousSequence) && (sequence < resultSequence)) {
+      result = page;
+      resultSequence = sequence;
+    }
+  }
+  return result;
+}
+
+uint32_t FlashLog::getSequence(uint16_t page) {
+  return ((const PageHeader*) mFlash->page(page))->sequence;
+}
+
+// Sets the head offset to the free space in the page, returns true when the
+// page changed the image. Checkpoint records are applied when the last one is
+// found, an interrupted checkpoint may hold a part of an interrupted write.
+bool FlashLog::replayPage(uint16_t page, uint16_t* checkpointPage, uint16_t* checkpointOffset) {
+  const uint8_t* data = mFlash->page(page);
+  bool changed = false;
+  mHeadOffset = mBlockSize;
+  while (mHeadOffset + sizeof(RecordHeader) <= mPageSize) {
+    const RecordHeader* header = (const RecordHeader*) (data + mHeadOffset);
+    if (isErased(data + mHeadOffset, sizeof(RecordHeader))) {
+      return changed;
+    }
+    const uint16_t bytes = recordBytes(header->size);
+    const uint8_t* recordData = data + mHeadOffset + sizeof(RecordHeader);
+    if ((header->size > mMaxRecordSize) || (mHeadOffset + bytes > mPageSize)
+        || (header->crc != crc16(recordData, header->size,
+            crc16((const uint8_t*) &header->sequence, sizeof(RecordHeader) - sizeof(header->crc))))) {
+      break; // interrupted record closes the page
+    }
+
+    if ((header->flags & kRecordCheckpoint) == 0) {
+      if (header->addr + header->size <= mImageSize) {
+        memcpy(mImage + header->addr, recordData, header->size);
+      }
+      *checkpointPage = kNoPage;
+      changed = true;
+    } else if (header->addr == 0) {
+      *checkpointPage = page;
+      *checkpointOffset = mHeadOffset;
+    }
+    if (((header->flags & kRecordCheckpoint) != 0) && (header->addr + header->size == mImageSize)
+        && (*checkpointPage != kNoPage)) {
+      applyCheckpoint(*checkpointPage, *checkpointOffset);
+      mTailPage = *checkpointPage;
+      *checkpointPage = kNoPage;
+      changed = true;
+    }
+    mRecordSequence = header->sequence + 1;
+    mHeadOffset += bytes;
+  }
+  mHeadOffset = mPageSize;
+  return changed;
+}
+
+// copies records of a complete checkpoint to the image
+void FlashLog::applyCheckpoint(uint16_t page, uint16_t offset) {
+  while (page != kNoPage) {
+    const uint8_t* data = mFlash->page(page);
+    if ((offset + sizeof(RecordHeader) > mPageSize) || isErased(data + offset, sizeof(RecordHeader))) {
+      page = findPage(getSequence(page));
+      offset = mBlockSize;
+      continue;
+    }
+    const RecordHeader* header = (const RecordHeader*) (data + offset);
+    if (header->addr + header->size > mImageSize) {
+      return;
+    }
+    memcpy(mImage + header->addr, data + offset + sizeof(RecordHeader), header->size);
+    if (header->addr + header->size == mImageSize) {
+      return;
+    }
+    offset += recordBytes(header->size);
+  }
+}
+
+uint16_t FlashLog::recordBytes(uint16_t size) {
+  return (sizeof(RecordHeader) + size + mBlockSize - 1) / mBlockSize * mBlockSize;
+}
+
+} // namespace util
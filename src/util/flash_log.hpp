@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * Licensed under GNU General Public License 3.0 or later.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef UTIL_FLASH_LOG_HPP_
+#define UTIL_FLASH_LOG_HPP_
+
+#include "flash.hpp"
+
+namespace util {
+
+// Log-structured store of a RAM image in a ring of flash pages.
+//
+// A write appends a record (sequence, address, size, CRC, data) to the head
+// page, so its cost scales with the bytes changed and the pages are erased in
+// turn. When the ring runs out of free pages the whole image is written as a
+// checkpoint from a new page and the pages before it are released.
+// load() replays the pages in order of their sequence numbers. A record with
+// a wrong CRC (power cut while programming) ends its page, pages left without
+// new data are reused.
+class FlashLog {
+public:
+  // largest supported flash block
+  static const uint16_t kMaxBlockSize = 16;
+  static const uint16_t kMaxPages = 32;
+
+  FlashLog(IFlash* flash, uint8_t* image, uint16_t imageSize);
+
+  // Rebuilds the image from flash, returns false if nothing is stored yet.
+  // Pages holding only an interrupted first checkpoint are reused.
+  bool load();
+
+  // Stores the image range. Erasing can be disabled for emergency writes,
+  // which use only erased pages and never compact the ring.
+  bool write(uint16_t addr, uint16_t size, bool mayErase);
+
+  // Compacts the ring if the next page change would need it
+  bool compactIfNeeded();
+
+  // Stores the whole image from a new page, the stored data is replaced only
+  // when the checkpoint is complete
+  bool checkpoint();
+
+  // only the pages reserved for a compaction are free
+  bool isFull() {
+    return getFreePages() <= mCheckpointPages;
+  }
+
+  // Erases one free page which is not blank yet, returns false if there is none.
+  // Lets the writes take only pages erased in advance.
+  bool eraseFreePage();
+
+  // Erases all pages, the image is kept
+  void format();
+
+  uint16_t getFreePages();
+
+private:
+  FlashLog(const FlashLog& other) = delete;
+  FlashLog& operator=(const FlashLog&) = delete;
+
+  typedef struct __attribute__((__packed__)) {
+    uint32_t sequence;
+    uint32_t tailSequence; // replay starts at this page
+    uint16_t magic;
+    uint16_t crc;
+  } PageHeader;
+
+  typedef struct __attribute__((__packed__)) {
+    uint16_t crc; // of the following fields and data
+    uint16_t sequence;
+    uint16_t addr;
+    uint8_t size;
+    uint8_t flags;
+  } RecordHeader;
+
+  static const uint16_t kNoPage = 0xffff;
+
+  bool append(uint16_t addr, uint16_t size, uint8_t flags, bool mayErase);
+  bool fits(uint16_t size);
+  bool openPage(bool mayErase);
+  bool isPageValid(uint16_t page);
+  uint16_t findPage(uint32_t previousSequence);
+  uint32_t getSequence(uint16_t page);
+  bool replayPage(uint16_t page, uint16_t* checkpointPage, uint16_t* checkpointOffset);
+  void applyCheckpoint(uint16_t page, uint16_t offset);
+  uint16_t recordBytes(uint16_t size);
+
+  IFlash* const mFlash;
+  uint8_t* const mImage;
+  const uint16_t mImageSize;
+  const uint16_t mPages;
+  const uint16_t mPageSize;
+  const uint16_t mBlockSize;
+  uint16_t mMaxRecordSize;
+  uint16_t mCheckpointPages;
+  uint16_t mHeadPage;
+  uint16_t mHeadOffset;
+  uint16_t mTailPage;
+  uint32_t mPageSequence;
+  uint16_t mRecordSequence;
+  uint32_t mValidPages; // bit per page with a valid header, set by load()
+};
+
+} // namespace util
+
+#endif // UTIL_FLASH_LOG_HPP_
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * Licensed under GNU General Public License 3.0 or later.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "flash_memory.hpp"
+
+#include "crc16.hpp"
+#include "flash_legacy.hpp"
+
+#include <string.h>
+
+namespace util {
+namespace {
+
+uint8_t countChunks(uint32_t chunks) {
+  uint8_t count = 0;
+  for (; chunks != 0; chunks &= chunks - 1) {
+    count++;
+  }
+  return count;
+}
+
+bool isErased(const uint8_t* data, uint16_t size) {
+  for (uint16_t i = 0; i < size; ++i) {
+    if (data[i] != 0xff) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint16_t getRecordCrc(const uint8_t* record) {
+  return record[0] | (record[1] << 8);
+}
+
+} // namespace
+
+FlashMemory::FlashMemory(IFlash* flash, IFlash* emergency, uint8_t* data, const Config* config, GetTimeMs getTimeMs) :
+    mLog(flash, data, config->size), mFlash(flash), mEmergency(emergency), mData(data), mConfig(config),
+    mGetTimeMs(getTimeMs), mDirty(0), mDataDirty(0), mSyncChunks(0), mEmergencyChunks(0), mChangeTime(0), mSyncTime(0),
+    mEmergencySlot(0), mEmergencyPending(false), mInitialized(false) {
+  for (uint16_t addr = config->tempAddr; addr < config->tempAddr + config->emergencySize; ++addr) {
+    mEmergencyChunks |= 1UL << (addr / kChunkSize);
+  }
+}
+
+size_t FlashMemory::write(uintptr_t addr, const uint8_t* data, size_t size, bool temp) {
+  if (!mInitialized) {
+    return 0;
+  }
+  uint8_t* writeData = mData + addr;
+  for (size_t i = 0; i < size; ++i, ++writeData, ++data) {
+    if (*writeData != *data) {
+      *writeData = *data;
+      uint32_t chunk = 1UL << ((addr + i) / kChunkSize);
+      mDirty |= chunk;
+      if (!temp) {
+        mDataDirty |= chunk;
+        mChangeTime = mGetTimeMs();
+      }
+    }
+  }
+  return size;
+}
+
+void FlashMemory::erase() {
+  mLog.format();
+  mEmergency->erase(0);
+  mEmergencySlot = 0;
+  mEmergencyPending = false;
+  mDirty = 0;
+  mDataDirty = 0;
+  mSyncChunks = 0;
+}
+
+void FlashMemory::initialize() {
+  // first boot after the update, the data of the A/B pages is the first
+  // checkpoint, the temp area is reset because its layout has changed
+  if (!mLog.load()
+      && loadLegacyImage(mFlash, mConfig->legacyPageA, mConfig->legacyPageB, mData, mConfig->tempAddr)) {
+    mLog.checkpoint();
+  }
+  loadEmergency();
+  mInitialized = true;
+}
+
+void FlashMemory::synchronize() {
+  saveEmergency();
+  uint32_t chunks = 0;
+  uint32_t dirty = mDataDirty;
+  for (uint8_t i = 0; (i < mConfig->emergencyChunks) && (dirty != 0); ++i) {
+    uint32_t chunk = dirty & (~dirty + 1);
+    chunks |= chunk;
+    dirty &= ~chunk;
+  }
+  while (writeChanges(chunks, false)) {
+  }
+}
+
+void FlashMemory::runSlice() {
+  if (!mInitialized || mLog.eraseFreePage()) {
+    return;
+  }
+  if (mLog.isFull()) {
+    mLog.compactIfNeeded();
+    return;
+  }
+  if (mEmergencyPending) {
+    // the log takes over the saved fields before the slots are erased
+    if ((mDirty & mEmergencyChunks) != 0) {
+      writeChanges(mEmergencyChunks, true);
+    } else {
+      mEmergency->erase(0);
+      mEmergencySlot = 0;
+      mEmergencyPending = false;
+    }
+    return;
+  }
+  uint32_t now = mGetTimeMs();
+  // more changes than a brown-out could store are stored at once
+  if ((mSyncChunks == 0) && (mDataDirty != 0)
+      && ((countChunks(mDataDirty) > mConfig->emergencyChunks)
+          || ((now - mChangeTime >= mConfig->quietMs) && (now - mSyncTime >= mConfig->minIntervalMs)))) {
+    mSyncChunks = mDataDirty;
+  }
+  if (mSyncChunks != 0) {
+    if (!writeChanges(mSyncChunks, true)) {
+      mSyncChunks = 0; // retry after the interval
+    }
+    if (mSyncChunks == 0) {
+      mSyncTime = now;
+    }
+  }
+}
+
+void FlashMemory::loadEmergency() {
+  const uint16_t blockSize = mEmergency->blockSize();
+  const uint16_t slots = mEmergency->pageSize() / blockSize;
+  const uint8_t* page = mEmergency->page(0);
+  const uint8_t* last = nullptr;
+  for (mEmergencySlot = 0; mEmergencySlot < slots; ++mEmergencySlot) {
+    const uint8_t* record = page + mEmergencySlot * blockSize;
+    if (isErased(record, blockSize)) {
+      break;
+    }
+    if (getRecordCrc(record) == crc16(record + kEmergencyHeaderSize, mConfig->emergencySize)) {
+      last = record;
+    }
+  }
+  if (last != nullptr) {
+    memcpy(mData + mConfig->tempAddr, last + kEmergencyHeaderSize, mConfig->emergencySize);
+    mDirty |= mEmergencyChunks;
+  }
+  mEmergencyPending = mEmergencySlot > 0;
+}
+
+bool FlashMemory::saveEmergency() {
+  const uint16_t blockSize = mEmergency->blockSize();
+  if (mEmergencySlot >= mEmergency->pageSize() / blockSize) {
+    return false; // the last saved slot is kept
+  }
+  uint8_t block[FlashLog::kMaxBlockSize];
+  memset(block, 0xff, sizeof(block));
+  memcpy(block + kEmergencyHeaderSize, mData + mConfig->tempAddr, mConfig->emergencySize);
+  uint16_t crc = crc16(block + kEmergencyHeaderSize, mConfig->emergencySize);
+  block[0] = (uint8_t) crc;
+  block[1] = (uint8_t) (crc >> 8);
+  mEmergencyPending = true;
+  return mEmergency->program(0, blockSize * mEmergencySlot++, block, blockSize);
+}
+
+// writes the first run of the changed chunks as a record
+bool FlashMemory::writeChanges(uint32_t chunks, bool mayErase) {
+  chunks &= mDirty;
+  if (chunks == 0) {
+    return false;
+  }
+  uint16_t addr = 0;
+  uint32_t chunk = 1;
+  while ((chunks & chunk) == 0) {
+    addr += kChunkSize;
+    chunk <<= 1;
+  }
+  uint16_t size = 0;
+  uint32_t run = 0;
+  for (; (chunks & chunk) != 0; chunk <<= 1) {
+    run |= chunk;
+    size += kChunkSize;
+  }
+  if (addr + size > mConfig->size) {
+    size = mConfig->size - addr;
+  }
+  if (!mLog.write(addr, size, mayErase)) {
+    return false;
+  }
+  mDirty &= ~run;
+  mDataDirty &= ~run;
+  mSyncChunks &= ~run;
+  return true;
+}
+
+} // namespace util
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * Licensed under GNU General Public License 3.0 or later.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef UTIL_FLASH_MEMORY_HPP_
+#define UTIL_FLASH_MEMORY_HPP_
+
+#include "flash_log.hpp"
+
+#include <stddef.h>
+
+namespace util {
+
+// RAM image of the data stored in the flash log. Changed chunks are appended
+// to the log in the background, after the data was not changed for a quiet
+// period and not more often than the minimum interval. Changes of the temp
+// area are stored only by the synchronization.
+//
+// On brown-out the volatile fields at the start of the temp area are saved
+// as one block in the next slot of a page erased in advance. The last slot
+// is merged at boot, stored in the log and the page is erased again.
+class FlashMemory {
+public:
+  static const uint16_t kChunkSize = 8;
+  static const uint16_t kMaxSize = 32 * kChunkSize;
+  // CRC before the volatile fields in the emergency block
+  static const uint16_t kEmergencyHeaderSize = sizeof(uint16_t);
+
+  typedef uint32_t (*GetTimeMs)();
+
+  typedef struct {
+    uint16_t size; // up to kMaxSize
+    uint16_t tempAddr;
+    uint16_t emergencySize; // up to the block size less kEmergencyHeaderSize
+    uint8_t emergencyChunks; // data chunks stored on brown-out
+    uint32_t quietMs;
+    uint32_t minIntervalMs;
+    // pages of the image stored before the flash log
+    uint16_t legacyPageA;
+    uint16_t legacyPageB;
+  } Config;
+
+  FlashMemory(IFlash* flash, IFlash* emergency, uint8_t* data, const Config* config, GetTimeMs getTimeMs);
+
+  size_t write(uintptr_t addr, const uint8_t* data, size_t size, bool temp);
+
+  const uint8_t* getData(uintptr_t addr) {
+    return mData + addr;
+  }
+
+  void erase();
+
+  // Loads the image, imports the legacy pages on the first boot after the
+  // update and merges the last emergency record
+  void initialize();
+
+  // Brown-out: saves the volatile fields first, then at most emergencyChunks
+  // changed data chunks without erasing a page. runSlice() keeps the changed
+  // data within that bound while the bus is idle, the rest of a longer burst
+  // of changes is lost.
+  void synchronize();
+
+  // one flash operation at a time: erase, compaction or a record
+  void runSlice();
+
+private:
+  FlashMemory(const FlashMemory& other) = delete;
+  FlashMemory& operator=(const FlashMemory&) = delete;
+
+  void loadEmergency();
+  bool saveEmergency();
+  bool writeChanges(uint32_t chunks, bool mayErase);
+
+  FlashLog mLog;
+  IFlash* const mFlash;
+  IFlash* const mEmergency;
+  uint8_t* const mData;
+  const Config* const mConfig;
+  const GetTimeMs mGetTimeMs;
+  uint32_t mDirty;
+  uint32_t mDataDirty;
+  uint32_t mSyncChunks;
+  uint32_t mEmergencyChunks;
+  uint32_t mChangeTime;
+  uint32_t mSyncTime;
+  uint8_t mEmergencySlot;
+  bool mEmergencyPending;
+  bool mInitialized;
+};
+
+} // namespace util
+
+#endif // UTIL_FLASH_MEMORY_HPP_
@@ -10,6 +10,169 @@
 
 #include "manchester.hpp"
 
+#define INVALID_SYMBOL 0xff
+
+namespace {
+
+#if (MANCHESTER_CODEC == MANCHESTER_CODEC_NIBBLE)
+
+// 4 data bits (MSB first) -> 8 bits of symbols
+const uint8_t kEncode4[16] = {
+    0xaa, 0xa9, 0xa6, 0xa5, 0x9a, 0x99, 0x96, 0x95,
+    0x6a, 0x69, 0x66, 0x65, 0x5a, 0x59, 0x56, 0x55,
+};
+
+// 4 data bits (LSB first, inverted symbols) -> 8 bits of symbols
+const uint8_t kEncodeInv4[16] = {
+    0x55, 0x95, 0x65, 0xa5, 0x59, 0x99, 0x69, 0xa9,
+    0x56, 0x96, 0x66, 0xa6, 0x5a, 0x9a, 0x6a, 0xaa,
+};
+
+// 4 bits of symbols -> 2 data bits or INVALID_SYMBOL
+const uint8_t kDecode4[16] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0x03, 0x02, 0xff,
+    0xff, 0x01, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+inline uint16_t encode8(uint8_t data) {
+  return ((uint16_t) kEncode4[data >> 4] << 8) | kEncode4[data & 0x0f];
+}
+
+inline uint16_t encodeInv8(uint8_t data) {
+  return ((uint16_t) kEncodeInv4[data & 0x0f] << 8) | kEncodeInv4[data >> 4];
+}
+
+// returns 0xffff for invalid symbol pair
+inline uint16_t decode8(uint16_t data) {
+  uint8_t d3 = kDecode4[(data >> 12) & 0x0f];
+  uint8_t d2 = kDecode4[(data >> 8) & 0x0f];
+  uint8_t d1 = kDecode4[(data >> 4) & 0x0f];
+  uint8_t d0 = kDecode4[data & 0x0f];
+  if ((d3 | d2 | d1 | d0) == INVALID_SYMBOL) {
+    return 0xffff;
+  }
+  return (d3 << 6) | (d2 << 4) | (d1 << 2) | d0;
+}
+
+#elif (MANCHESTER_CODEC == MANCHESTER_CODEC_BYTE)
+
+// 8 data bits (MSB first) -> 16 bits of symbols
+const uint16_t kEncode8[256] = {
+    0xaaaa, 0xaaa9, 0xaaa6, 0xaaa5, 0xaa9a, 0xaa99, 0xaa96, 0xaa95,
+    0xaa6a, 0xaa69, 0xaa66, 0xaa65, 0xaa5a, 0xaa59, 0xaa56, 0xaa55,
+    0xa9aa, 0xa9a9, 0xa9a6, 0xa9a5, 0xa99a, 0xa999, 0xa996, 0xa995,
+    0xa96a, 0xa969, 0xa966, 0xa965, 0xa95a, 0xa959, 0xa956, 0xa955,
+    0xa6aa, 0xa6a9, 0xa6a6, 0xa6a5, 0xa69a, 0xa699, 0xa696, 0xa695,
+    0xa66a, 0xa669, 0xa666, 0xa665, 0xa65a, 0xa659, 0xa656, 0xa655,
+    0xa5aa, 0xa5a9, 0xa5a6, 0xa5a5, 0xa59a, 0xa599, 0xa596, 0xa595,
+    0xa56a, 0xa569, 0xa566, 0xa565, 0xa55a, 0xa559, 0xa556, 0xa555,
+    0x9aaa, 0x9aa9, 0x9aa6, 0x9aa5, 0x9a9a, 0x9a99, 0x9a96, 0x9a95,
+    0x9a6a, 0x9a69, 0x9a66, 0x9a65, 0x9a5a, 0x9a59, 0x9a56, 0x9a55,
+    0x99aa, 0x99a9, 0x99a6, 0x99a5, 0x999a, 0x9999, 0x9996, 0x9995,
+    0x996a, 0x9969, 0x9966, 0x9965, 0x995a, 0x9959, 0x9956, 0x9955,
+    0x96aa, 0x96a9, 0x96a6, 0x96a5, 0x969a, 0x9699, 0x9696, 0x9695,
+    0x966a, 0x9669, 0x9666, 0x9665, 0x965a, 0x9659, 0x9656, 0x9655,
+    0x95aa, 0x95a9, 0x95a6, 0x95a5, 0x959a, 0x9599, 0x9596, 0x9595,
+    0x956a, 0x9569, 0x9566, 0x9565, 0x955a, 0x9559, 0x9556, 0x9555,
+    0x6aaa, 0x6aa9, 0x6aa6, 0x6aa5, 0x6a9a, 0x6a99, 0x6a96, 0x6a95,
+    0x6a6a, 0x6a69, 0x6a66, 0x6a65, 0x6a5a, 0x6a59, 0x6a56, 0x6a55,
+    0x69aa, 0x69a9, 0x69a6, 0x69a5, 0x699a, 0x6999, 0x6996, 0x6995,
+    0x696a, 0x6969, 0x6966, 0x6965, 0x695a, 0x6959, 0x6956, 0x6955,
+    0x66aa, 0x66a9, 0x66a6, 0x66a5, 0x669a, 0x6699, 0x6696, 0x6695,
+    0x666a, 0x6669, 0x6666, 0x6665, 0x665a, 0x6659, 0x6656, 0x6655,
+    0x65aa, 0x65a9, 0x65a6, 0x65a5, 0x659a, 0x6599, 0x6596, 0x6595,
+    0x656a, 0x6569, 0x6566, 0x6565, 0x655a, 0x6559, 0x6556, 0x6555,
+    0x5aaa, 0x5aa9, 0x5aa6, 0x5aa5, 0x5a9a, 0x5a99, 0x5a96, 0x5a95,
+    0x5a6a, 0x5a69, 0x5a66, 0x5a65, 0x5a5a, 0x5a59, 0x5a56, 0x5a55,
+    0x59aa, 0x59a9, 0x59a6, 0x59a5, 0x599a, 0x5999, 0x5996, 0x5995,
+    0x596a, 0x5969, 0x5966, 0x5965, 0x595a, 0x5959, 0x5956, 0x5955,
+    0x56aa, 0x56a9, 0x56a6, 0x56a5, 0x569a, 0x5699, 0x5696, 0x5695,
+    0x566a, 0x5669, 0x5666, 0x5665, 0x565a, 0x5659, 0x5656, 0x5655,
+    0x55aa, 0x55a9, 0x55a6, 0x55a5, 0x559a, 0x5599, 0x5596, 0x5595,
+    0x556a, 0x5569, 0x5566, 0x5565, 0x555a, 0x5559, 0x5556, 0x5555,
+};
+
+// 8 data bits (LSB first, inverted symbols) -> 16 bits of symbols
+const uint16_t kEncodeInv8[256] = {
+    0x5555, 0x9555, 0x6555, 0xa555, 0x5955, 0x9955, 0x6955, 0xa955,
+    0x5655, 0x9655, 0x6655, 0xa655, 0x5a55, 0x9a55, 0x6a55, 0xaa55,
+    0x5595, 0x9595, 0x6595, 0xa595, 0x5995, 0x9995, 0x6995, 0xa995,
+    0x5695, 0x9695, 0x6695, 0xa695, 0x5a95, 0x9a95, 0x6a95, 0xaa95,
+    0x5565, 0x9565, 0x6565, 0xa565, 0x5965, 0x9965, 0x6965, 0xa965,
+    0x5665, 0x9665, 0x6665, 0xa665, 0x5a65, 0x9a65, 0x6a65, 0xaa65,
+    0x55a5, 0x95a5, 0x65a5, 0xa5a5, 0x59a5, 0x99a5, 0x69a5, 0xa9a5,
+    0x56a5, 0x96a5, 0x66a5, 0xa6a5, 0x5aa5, 0x9aa5, 0x6aa5, 0xaaa5,
+    0x5559, 0x9559, 0x6559, 0xa559, 0x5959, 0x9959, 0x6959, 0xa959,
+    0x5659, 0x9659, 0x6659, 0xa659, 0x5a59, 0x9a59, 0x6a59, 0xaa59,
+    0x5599, 0x9599, 0x6599, 0xa599, 0x5999, 0x9999, 0x6999, 0xa999,
+    0x5699, 0x9699, 0x6699, 0xa699, 0x5a99, 0x9a99, 0x6a99, 0xaa99,
+    0x5569, 0x9569, 0x6569, 0xa569, 0x5969, 0x9969, 0x6969, 0xa969,
+    0x5669, 0x9669, 0x6669, 0xa669, 0x5a69, 0x9a69, 0x6a69, 0xaa69,
+    0x55a9, 0x95a9, 0x65a9, 0xa5a9, 0x59a9, 0x99a9, 0x69a9, 0xa9a9,
+    0x56a9, 0x96a9, 0x66a9, 0xa6a9, 0x5aa9, 0x9aa9, 0x6aa9, 0xaaa9,
+    0x5556, 0x9556, 0x6556, 0xa556, 0x5956, 0x9956, 0x6956, 0xa956,
+    0x5656, 0x9656, 0x6656, 0xa656, 0x5a56, 0x9a56, 0x6a56, 0xaa56,
+    0x5596, 0x9596, 0x6596, 0xa596, 0x5996, 0x9996, 0x6996, 0xa996,
+    0x5696, 0x9696, 0x6696, 0xa696, 0x5a96, 0x9a96, 0x6a96, 0xaa96,
+    0x5566, 0x9566, 0x6566, 0xa566, 0x5966, 0x9966, 0x6966, 0xa966,
+    0x5666, 0x9666, 0x6666, 0xa666, 0x5a66, 0x9a66, 0x6a66, 0xaa66,
+    0x55a6, 0x95a6, 0x65a6, 0xa5a6, 0x59a6, 0x99a6, 0x69a6, 0xa9a6,
+    0x56a6, 0x96a6, 0x66a6, 0xa6a6, 0x5aa6, 0x9aa6, 0x6aa6, 0xaaa6,
+    0x555a, 0x955a, 0x655a, 0xa55a, 0x595a, 0x995a, 0x695a, 0xa95a,
+    0x565a, 0x965a, 0x665a, 0xa65a, 0x5a5a, 0x9a5a, 0x6a5a, 0xaa5a,
+    0x559a, 0x959a, 0x659a, 0xa59a, 0x599a, 0x999a, 0x699a, 0xa99a,
+    0x569a, 0x969a, 0x669a, 0xa69a, 0x5a9a, 0x9a9a, 0x6a9a, 0xaa9a,
+    0x556a, 0x956a, 0x656a, 0xa56a, 0x596a, 0x996a, 0x696a, 0xa96a,
+    0x566a, 0x966a, 0x666a, 0xa66a, 0x5a6a, 0x9a6a, 0x6a6a, 0xaa6a,
+    0x55aa, 0x95aa, 0x65aa, 0xa5aa, 0x59aa, 0x99aa, 0x69aa, 0xa9aa,
+    0x56aa, 0x96aa, 0x66aa, 0xa6aa, 0x5aaa, 0x9aaa, 0x6aaa, 0xaaaa,
+};
+
+// 8 bits of symbols -> 4 data bits or INVALID_SYMBOL
+const uint8_t kDecode8[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0x0f, 0x0e, 0xff, 0xff, 0x0d, 0x0c, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0x0b, 0x0a, 0xff, 0xff, 0x09, 0x08, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0x07, 0x06, 0xff, 0xff, 0x05, 0x04, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0x03, 0x02, 0xff,
+    0xff, 0x01, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+inline uint16_t encode8(uint8_t data) {
+  return kEncode8[data];
+}
+
+inline uint16_t encodeInv8(uint8_t data) {
+  return kEncodeInv8[data];
+}
+
+// returns 0xffff for invalid symbol pair
+inline uint16_t decode8(uint16_t data) {
+  uint8_t d1 = kDecode8[data >> 8];
+  uint8_t d0 = kDecode8[data & 0xff];
+  if ((d1 | d0) == INVALID_SYMBOL) {
+    return 0xffff;
+  }
+  return (d1 << 4) | d0;
+}
+
+#endif // MANCHESTER_CODEC
+
+} // namespace
+
+#if (MANCHESTER_CODEC == MANCHESTER_CODEC_BITWISE)
+
 uint32_t manchesterEncode16(uint16_t data) {
   uint32_t result = 0xffffffff;
   for (uint8_t i = 0; i < 8; ++i) {
@@ -111,3 +274,36 @@ uint16_t manchesterDecode16(uint32_t data) {
   }
   return result;
 }
+
+#else
+
+uint32_t manchesterEncode16(uint16_t data) {
+  return 0xffff0000 | encode8(data);
+}
+
+uint32_t manchesterEncode32(uint16_t data) {
+  return ((uint32_t) encode8(data >> 8) << 16) | encode8(data);
+}
+
+uint32_t manchesterEncode16Inv(uint16_t data) {
+  return 0xffff0000 | encodeInv8(data);
+}
+
+uint32_t manchesterEncode32Inv(uint16_t data) {
+  return ((uint32_t) encodeInv8(data) << 16) | encodeInv8(data >> 8);
+}
+
+uint16_t manchesterDecode32(uint32_t data) {
+  uint16_t h = decode8(data >> 16);
+  uint16_t l = decode8(data & 0xffff);
+  if ((h | l) == 0xffff) {
+    return 0xffff;
+  }
+  return (h << 8) | l;
+}
+
+uint16_t manchesterDecode16(uint32_t data) {
+  return decode8(data & 0xffff);
+}
+
+#endif // MANCHESTER_CODEC
@@ -13,6 +13,20 @@
 
 #include <stdint.h>
 
+// Codec implementation, selected at compile time to trade flash for cycles:
+//  MANCHESTER_CODEC_BITWISE - bit by bit loops, no tables
+//  MANCHESTER_CODEC_NIBBLE  - 4 bit indexed tables (48 bytes of flash)
+//  MANCHESTER_CODEC_BYTE    - 8 bit indexed tables (1280 bytes of flash)
+#define MANCHESTER_CODEC_BITWISE 0
+#define MANCHESTER_CODEC_NIBBLE 1
+#define MANCHESTER_CODEC_BYTE 2
+
+#ifndef MANCHESTER_CODEC
+# define MANCHESTER_CODEC MANCHESTER_CODEC_BYTE
+#endif
+
+// Decode functions return 0xffff for an invalid symbol pair
+
 uint32_t manchesterEncode16(uint16_t data);
 uint32_t manchesterEncode32(uint16_t data);
 uint32_t manchesterEncode16Inv(uint16_t data);
@@ -11,8 +11,12 @@
 #include "bus.hpp"
 
 #include "bus_config.h"
+#include "events.hpp"
 #include "timer.hpp"
 
+#include <dali/address_filter.hpp>
+#include <util/bus_line.hpp>
+#include <util/fifo.hpp>
 #include <util/manchester.hpp>
 
 using namespace ::dali;
@@ -33,27 +37,62 @@ namespace {
 #define PULSE_TIME_LONG_MIN (PULSE_TIME_MIN * 2)
 #define PULSE_TIME_LONG_MAX (PULSE_TIME_MAX * 2)
 
-#define INVALID32 0xffffffffL
 #define INVALID16 0xffff
 
+// CCU4 slice runs at 32MHz and stops on period match when the bus is quiet
+#define RX_TIMEOUT_TICKS 65535
+#define RX_TIMEOUT_US ((RX_TIMEOUT_TICKS + 1) / 32)
+
+// settling time between end of the forward frame and the backward frame
+#define TX_SETTLING_MIN_US 2400
+#define TX_SETTLING_MAX_US 10500
+#define TX_DELAY_US 5000
+
+static_assert(TX_DELAY_US >= TX_SETTLING_MIN_US && TX_DELAY_US < TX_SETTLING_MAX_US, "invalid TX delay");
+
+#define RX_FIFO_SIZE 8
+
+// bus low for longer is a disconnection
+#define BUS_DISCONNECT_MS 500
+
 enum class RxState {
   IDLE, START_LOW, START_HIGHT, DATA_LOW, DATA_HIGHT, HAVE_DATA, ERROR
 };
 
+typedef struct {
+  uint32_t data; // Manchester encoded
+  Time time; // end of the frame in us
+} RxFrame;
+
 uint8_t gRxDataBit = 0;
 volatile RxState gRxState;
-volatile uint32_t gRxData32 = INVALID32;
 volatile uint32_t gRxDataTmp;
-uint16_t gTxData = INVALID16;
-volatile Time gBusLowTime = 0;
+util::Fifo<RxFrame, RX_FIFO_SIZE> gRxFrames;
+AddressFilter gAddressFilter;
+uint32_t gRxFiltered = 0;
+Time gLastRxTime = 0;
+volatile uint16_t gTxData = INVALID16;
+uint32_t gTxDropped = 0;
+uint32_t gTxSettlingHistogram[Bus::kTxHistogramSize];
+util::BusLine gBusLine;
 
 #define MAX_CLIENTS 1
 
 IBusDriver::IBusState gBusState = IBusDriver::IBusState::UNKNOWN;
 IBusDriver::IBusClient* gClients[MAX_CLIENTS];
 
+// checks the bus again when a low bus becomes a disconnection
+class DisconnectTimerTask: public ITimer::ITimerTask {
+public:
+  void timerTaskRun() override {
+    Bus::runState();
+  }
+};
+
+DisconnectTimerTask gDisconnectTimerTask;
+
 void onRisingEdge(uint16_t timer) {
-  gBusLowTime = kTimeInvalid;
+  gBusLine.onRisingEdge();
 
   if (timer == 0) {
     return;
@@ -99,7 +138,7 @@ void onRisingEdge(uint16_t timer) {
 }
 
 void onFallingEdge(uint16_t timer) {
-  gBusLowTime = Timer::getTimeMs();
+  gBusLine.onFallingEdge(Timer::getTimeMs());
 
   if (timer == 0) {
     gRxState = RxState::START_LOW;
@@ -150,25 +189,84 @@ void onFallingEdge(uint16_t timer) {
   }
 }
 
+void cancelTx() {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  XMC_CCU4_SLICE_StopTimer(CCU40_TX_SLICE);
+  XMC_CCU4_SLICE_ClearEvent(CCU40_TX_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+  NVIC_ClearPendingIRQ(CCU40_0_IRQn);
+  gTxData = INVALID16;
+  __set_PRIMASK(primask);
+}
+
 void onTimeOut() {
+  // the bus is quiet, but still low or released after a disconnection
+  if (!gBusLine.isHigh() || (gBusState != IBusDriver::IBusState::CONNECTED)) {
+    Events::post(Event::BUS_STATE);
+  }
+
   if (gRxState == RxState::ERROR) {
     gRxDataBit = -1; // prevent unexpected data
   }
 
   gRxState = RxState::IDLE;
-  gRxData32 = INVALID32;
 
+  RxFrame frame;
   switch (gRxDataBit) {
   case 32:
-    gRxData32 = gRxDataTmp;
+    frame.data = gRxDataTmp;
     break;
 
   case 32 - 1:
-    gRxData32 = gRxDataTmp;
-    gRxData32 <<= 1;
-    gRxData32 |= 1;
+    frame.data = gRxDataTmp;
+    frame.data <<= 1;
+    frame.data |= 1;
     break;
+
+  default:
+    return;
+  }
+  // the last edge was RX_TIMEOUT_US before the period match
+  frame.time = Timer::getTimeUs() - RX_TIMEOUT_US;
+
+  // an answer not sent yet would collide with the next forward frame
+  if (gTxData != INVALID16) {
+    cancelTx();
+    gTxDropped++;
+  }
+
+  uint16_t addr = manchesterDecode16(frame.data >> 16);
+  if (addr > 0xff || !gAddressFilter.match(addr)) {
+    gRxFiltered++; // invalid or not for us
+    return;
+  }
+  if (gRxFrames.push(frame)) {
+    Events::post(Event::FRAME);
+  }
+}
+
+void onTxTime() {
+  uint16_t data = gTxData;
+  gTxData = INVALID16;
+  if (data == INVALID16) {
+    return;
+  }
+  if (gRxState != RxState::IDLE) {
+    gTxDropped++; // somebody else is transmitting
+    return;
+  }
+  uint32_t txData = manchesterEncode16Inv(data);
+  txData <<= 1;
+  txData |= 0x01;
+  XMC_UART_CH_Transmit(DALI_UART_CH, (uint16_t) (txData & 0xffff));
+  XMC_UART_CH_Transmit(DALI_UART_CH, (uint16_t) (txData >> 16));
+
+  uint32_t settlingTime = timeDiff(Timer::getTimeUs(), gLastRxTime);
+  uint32_t bucket = settlingTime / Bus::kTxHistogramBucketUs;
+  if (bucket >= Bus::kTxHistogramSize) {
+    bucket = Bus::kTxHistogramSize - 1;
   }
+  gTxSettlingHistogram[bucket]++;
 }
 
 } // namespace
@@ -182,6 +280,7 @@ Bus* Bus::getInstance() {
 Bus::Bus() {
   Bus::initRx();
   Bus::initTx();
+  Events::post(Event::BUS_STATE); // the bus may stay quiet
 }
 
 Bus::~Bus() {
@@ -214,28 +313,67 @@ Status Bus::sendAck(uint8_t ack) {
   return Status::OK;
 }
 
-void Bus::runSlice() {
-  uint16_t data;
-  Time time = Timer::getTimeMs();
-
+Status Bus::setAddressFilter(const AddressFilter& filter) {
   __disable_irq();
-  Time busLowTime = gBusLowTime;
+  gAddressFilter = filter;
   __enable_irq();
+  return Status::OK;
+}
+
+// static
+bool Bus::isIdle() {
+  return (gRxState == RxState::IDLE) && (gTxData == INVALID16) && gBusLine.isHigh() && gRxFrames.isEmpty();
+}
+
+uint32_t Bus::getRxOverflows() {
+  return gRxFrames.getOverflows();
+}
 
-  if (busLowTime == kTimeInvalid) {
+uint32_t Bus::getRxFiltered() {
+  return gRxFiltered;
+}
+
+const uint32_t* Bus::getTxSettlingHistogram() {
+  return gTxSettlingHistogram;
+}
+
+uint32_t Bus::getTxDropped() {
+  return gTxDropped;
+}
+
+// static
+void Bus::runState() {
+  Time busLowTime = gBusLine.getLowTimeMs();
+
+  if (busLowTime == util::BusLine::kHigh) {
     if (gBusState != IBusDriver::IBusState::CONNECTED) {
       onBusStateChanged(IBusDriver::IBusState::CONNECTED);
     }
-  } else {
-    if (time - busLowTime >= 500) {
-      if (gBusState != IBusDriver::IBusState::DISCONNECTED) {
-        onBusStateChanged(IBusDriver::IBusState::DISCONNECTED);
-      }
-    }
+    return;
+  }
+  uint32_t elapsed = timeDiff(Timer::getTimeMs(), busLowTime);
+  if (elapsed < BUS_DISCONNECT_MS) {
+    Timer::getInstance()->schedule(&gDisconnectTimerTask, BUS_DISCONNECT_MS - elapsed, 0);
+  } else if (gBusState != IBusDriver::IBusState::DISCONNECTED) {
+    onBusStateChanged(IBusDriver::IBusState::DISCONNECTED);
   }
+}
 
-  if (Bus::checkRxTx(time, &data)) {
-    onDataReceived(time, data);
+// static
+void Bus::runFrame() {
+  RxFrame frame;
+  if (!gRxFrames.pop(&frame)) {
+    return;
+  }
+  // an answer not sent yet belongs to the previous frame
+  if (gTxData != INVALID16) {
+    cancelTx();
+    gTxDropped++;
+  }
+  gLastRxTime = frame.time;
+  onDataReceived(frame.time, manchesterDecode32(frame.data));
+  if (!gRxFrames.isEmpty()) {
+    Events::post(Event::FRAME);
   }
 }
 
@@ -262,14 +400,13 @@ void Bus::onBusStateChanged(IBusState state) {
 //static
 void Bus::initRx() {
   XMC_GPIO_SetMode(CCU40_RX_PIN, DALI_XMC_CCU40_RX_PIN_MODE);
+  // before the edge interrupts, a quiet bus is idle since the start
+  gBusLine.reset(XMC_GPIO_GetInput(CCU40_RX_PIN) != 0, Timer::getTimeMs());
 
-  XMC_CCU4_Init(CCU40, XMC_CCU4_SLICE_MCMS_ACTION_TRANSFER_PR_CR);
-  XMC_CCU4_StartPrescaler(CCU40);
-  XMC_CCU4_SetModuleClock(CCU40, XMC_CCU4_CLOCK_SCU);
-
+  // the CCU40 module is already started by the Timer
   XMC_CCU4_SLICE_CaptureInit(CCU40_SLICE, &kDaliRxCCU4CaptureConfig);
 
-  XMC_CCU4_SLICE_SetTimerPeriodMatch(CCU40_SLICE, 65535);
+  XMC_CCU4_SLICE_SetTimerPeriodMatch(CCU40_SLICE, RX_TIMEOUT_TICKS);
   XMC_CCU4_EnableShadowTransfer(CCU40, CCU40_SLICE_SHADDOW_TRANSFER);
 
   XMC_CCU4_SLICE_Capture0Config(CCU40_SLICE, XMC_CCU4_SLICE_EVENT_0);
@@ -295,57 +432,54 @@ void Bus::initRx() {
   XMC_CCU4_EnableClock(CCU40, CCU40_SLICE_NUMBER);
 }
 
-//static
-bool Bus::checkRxTx(Time time, uint16_t* data) {
-  static Time gLastDataTime = 0;
-  bool rxResult = false;
-  __disable_irq();
-  uint32_t rxData32 = gRxData32;
-  gRxData32 = INVALID32;
-  __enable_irq();
-  if (rxData32 != INVALID32) {
-    gLastDataTime = time;
-
-    *data = manchesterDecode32(rxData32);
-    rxResult = true;
-  }
-
-  if (gTxData != INVALID16) {
-    Time dTime = time - gLastDataTime;
-    if (dTime > 3) {
-      if (gRxState == RxState::IDLE) {
-        uint16_t tmpTxData = gTxData;
-        gTxData = INVALID16;
-        uint32_t txData = manchesterEncode16Inv(tmpTxData);
-        txData <<= 1;
-        txData |= 0x01;
-        XMC_UART_CH_Transmit(DALI_UART_CH, (uint16_t) (txData & 0xffff));
-        XMC_UART_CH_Transmit(DALI_UART_CH, (uint16_t) (txData >> 16));
-      } else {
-        gTxData = INVALID16;
-      }
-    }
-  }
-  return rxResult;
-}
-
 // static
 void Bus::initTx() {
   XMC_UART_CH_Init(DALI_UART_CH, &kDaliTxUARTConfig);
   XMC_USIC_CH_TXFIFO_Configure(DALI_UART_CH, 0, XMC_USIC_CH_FIFO_DISABLED, 0);
   XMC_UART_CH_Start(DALI_UART_CH);
   XMC_GPIO_SetMode(DALI_UART_TX_PIN, DALI_UART_TX_PIN_MODE);
+
+  XMC_CCU4_SLICE_CompareInit(CCU40_TX_SLICE, &kDaliTxCCU4TimerConfig);
+  XMC_CCU4_SLICE_EnableEvent(CCU40_TX_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+  XMC_CCU4_SLICE_SetInterruptNode(CCU40_TX_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH, XMC_CCU4_SLICE_SR_ID_0);
+  NVIC_SetPriority(CCU40_0_IRQn, 2);
+  NVIC_EnableIRQ(CCU40_0_IRQn);
+  XMC_CCU4_EnableClock(CCU40, CCU40_TX_SLICE_NUMBER);
 }
 
 // static
 void Bus::tx(uint8_t data) {
-  if (gTxData == INVALID16) {
-    gTxData = data;
+  if (gTxData != INVALID16) {
+    return;
+  }
+  uint32_t elapsed = timeDiff(Timer::getTimeUs(), gLastRxTime);
+  if (elapsed >= TX_SETTLING_MAX_US) {
+    gTxDropped++; // too late to answer
+    return;
   }
+  uint32_t delay = 1;
+  if (elapsed < TX_DELAY_US) {
+    delay = TX_DELAY_US - (uint32_t) elapsed;
+  }
+  gTxData = data;
+  // the timer counts microseconds, period match is reached after (period + 1)
+  XMC_CCU4_SLICE_SetTimerPeriodMatch(CCU40_TX_SLICE, delay - 1);
+  XMC_CCU4_EnableShadowTransfer(CCU40, CCU40_TX_SLICE_SHADDOW_TRANSFER);
+  XMC_CCU4_SLICE_ClearTimer(CCU40_TX_SLICE);
+  XMC_CCU4_SLICE_StartTimer(CCU40_TX_SLICE);
 }
 
 extern "C" {
 
+// shared with the timer slices
+void CCU40_0_IRQHandler(void) {
+  Timer::onInterrupt();
+  if (XMC_CCU4_SLICE_GetEvent(CCU40_TX_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH)) {
+    XMC_CCU4_SLICE_ClearEvent(CCU40_TX_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+    onTxTime();
+  }
+}
+
 void CCU40_1_IRQHandler(void) {
   XMC_CCU4_SLICE_ClearEvent(CCU40_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
   onTimeOut();
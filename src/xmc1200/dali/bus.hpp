@@ -16,15 +16,33 @@
 namespace dali {
 namespace xmc {
 
-class Bus: public dali::IBusDriver {
+class Bus final: public dali::IBusDriver {
 public:
   static Bus* getInstance();
 
   dali::Status registerClient(IBusClient* c) override;
   dali::Status unregisterClient(IBusClient* c) override;
   dali::Status sendAck(uint8_t ack) override;
+  dali::Status setAddressFilter(const AddressFilter& filter) override;
 
-  static void runSlice();
+  // handles the next received frame, on Event::FRAME
+  static void runFrame();
+  // reports a connection or disconnection, on Event::BUS_STATE
+  static void runState();
+  // nothing is received, queued or waiting to be sent
+  static bool isIdle();
+
+  // number of received frames lost because runFrame() was late
+  static uint32_t getRxOverflows();
+  // number of received frames dropped in the interrupt (invalid or not for us)
+  static uint32_t getRxFiltered();
+
+  // achieved backward frame settling times, the last bucket collects all later frames
+  static const uint32_t kTxHistogramBucketUs = 500;
+  static const uint8_t kTxHistogramSize = 24;
+  static const uint32_t* getTxSettlingHistogram();
+  // number of backward frames not sent (late, cancelled or collision)
+  static uint32_t getTxDropped();
 
 private:
   Bus();
@@ -33,11 +51,10 @@ private:
 
   ~Bus();
 
-  static void onDataReceived(Time timeMs, uint16_t data);
+  static void onDataReceived(Time time, uint16_t data);
   static void onBusStateChanged(IBusState state);
 
   static void initRx();
-  static bool checkRxTx(Time time, uint16_t* data);
 
   static void initTx();
   static void tx(uint8_t data);
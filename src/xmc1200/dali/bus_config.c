@@ -39,3 +39,18 @@ const XMC_CCU4_SLICE_CAPTURE_CONFIG_t kDaliRxCCU4CaptureConfig = {
     float_limit: 0,
     timer_concatenation: 0
 };
+
+const XMC_CCU4_SLICE_COMPARE_CONFIG_t kDaliTxCCU4TimerConfig = {
+    timer_mode: XMC_CCU4_SLICE_TIMER_COUNT_MODE_EA,
+    monoshot: XMC_CCU4_SLICE_TIMER_REPEAT_MODE_SINGLE,
+    shadow_xfer_clear: 0,
+    dither_timer_period: 0,
+    dither_duty_cycle: 0,
+    prescaler_mode: XMC_CCU4_SLICE_PRESCALER_MODE_NORMAL,
+    mcm_enable: 0,
+    prescaler_initval: XMC_CCU4_SLICE_PRESCALER_32,
+    float_limit: 0,
+    dither_limit: 0,
+    passive_level: XMC_CCU4_SLICE_OUTPUT_PASSIVE_LEVEL_LOW,
+    timer_concatenation: 0
+};
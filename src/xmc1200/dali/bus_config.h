@@ -34,4 +34,11 @@ extern const XMC_CCU4_SLICE_EVENT_CONFIG_t kDaliRxCCU4CaptureRisingConfig;
 extern const XMC_CCU4_SLICE_EVENT_CONFIG_t kDaliRxCCU4CaptureFallingConfig;
 extern const XMC_CCU4_SLICE_CAPTURE_CONFIG_t kDaliRxCCU4CaptureConfig;
 
+// CCU4 configuration - used for DALI TX timing (1MHz single shot)
+# define CCU40_TX_SLICE CCU40_CC43
+# define CCU40_TX_SLICE_NUMBER 3
+# define CCU40_TX_SLICE_SHADDOW_TRANSFER XMC_CCU4_SHADOW_TRANSFER_SLICE_3
+
+extern const XMC_CCU4_SLICE_COMPARE_CONFIG_t kDaliTxCCU4TimerConfig;
+
 #endif // XMC_DALI_BUS_CONFIG_H_
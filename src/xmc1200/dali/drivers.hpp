@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * Licensed under GNU General Public License 3.0 or later.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef XMC_DALI_DRIVERS_HPP_
+#define XMC_DALI_DRIVERS_HPP_
+
+// Static driver binding, enabled with
+// -DDALI_DRIVERS_HEADER="<xmc1200/dali/drivers.hpp>"
+
+#include "bus.hpp"
+#include "lamp.hpp"
+#include "memory.hpp"
+#include "timer.hpp"
+
+namespace dali {
+
+typedef xmc::Memory MemoryDriver;
+typedef xmc::LampRGB LampDriver;
+typedef xmc::Bus BusDriver;
+typedef xmc::Timer TimerDriver;
+typedef xmc::LampRGB LampDT8Driver;
+
+} // namespace dali
+
+#endif // XMC_DALI_DRIVERS_HPP_
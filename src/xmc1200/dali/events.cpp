@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * Licensed under GNU General Public License 3.0 or later.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "events.hpp"
+
+#include "timer.hpp"
+
+#include <util/event_queue.hpp>
+
+namespace dali {
+namespace xmc {
+
+namespace {
+
+util::EventQueue<(uint8_t) Event::COUNT> gEvents;
+
+}
+
+// static
+void Events::post(Event event) {
+  gEvents.post((uint8_t) event, Timer::getTimeUs());
+}
+
+// static
+bool Events::take(Event* event) {
+  uint8_t next = gEvents.take(Timer::getTimeUs());
+  if (next == util::EventQueue<(uint8_t) Event::COUNT>::kNone) {
+    return false;
+  }
+  *event = (Event) next;
+  return true;
+}
+
+// static
+uint8_t Events::getMaxDepth() {
+  return gEvents.getMaxDepth();
+}
+
+// static
+uint32_t Events::getMaxLatencyUs(Event event) {
+  return gEvents.getMaxLatencyUs((uint8_t) event);
+}
+
+} // namespace xmc
+} // namespace dali
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2015-2016, Arkadiusz Materek (arekmat@poczta.fm)
+ *
+ * Licensed under GNU General Public License 3.0 or later.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef XMC_DALI_EVENTS_HPP_
+#define XMC_DALI_EVENTS_HPP_
+
+#include <stdint.h>
+
+namespace dali {
+namespace xmc {
+
+// Work of the main loop, the most urgent first
+enum class Event: uint8_t {
+  POWER_DOWN, // brown-out, the memory is saved before anything else
+  FRAME,      // a received forward frame waits for its backward frame
+  BUS_STATE,  // the bus is low or back after a disconnection
+  TIMER,      // a timer task is due
+  COUNT
+};
+
+class Events {
+public:
+  // can be called from interrupts, an event already pending is merged
+  static void post(Event event);
+  // the most urgent pending event, false if there is nothing to do
+  static bool take(Event* event);
+
+  // the highest number of events pending at once
+  static uint8_t getMaxDepth();
+  // the longest time from the post to the take of the event
+  static uint32_t getMaxLatencyUs(Event event);
+};
+
+} // namespace xmc
+} // namespace dali
+
+#endif // XMC_DALI_EVENTS_HPP_
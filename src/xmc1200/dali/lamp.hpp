@@ -17,7 +17,7 @@
 namespace dali {
 namespace xmc {
 
-class LampRGB: public dali::ILampDT8 {
+class LampRGB final: public dali::ILampDT8 {
 public:
 
   static LampRGB* getInstance();
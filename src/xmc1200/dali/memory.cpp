@@ -13,321 +13,138 @@
 #include "memory_config.hpp"
 #include "timer.hpp"
 
+#include <dali/controller/memory_dt8.hpp>
+#include <util/flash_memory.hpp>
+
+#include <string.h>
+
 namespace dali {
 namespace xmc {
 namespace {
 
-#define FLASH_MEMORY_OFFSET 4
-#define FLASH_MEMORY_SIZE (XMC_FLASH_BYTES_PER_PAGE - FLASH_MEMORY_OFFSET)
-
-class FlashMemory {
+#define FLASH_MEMORY_SIZE 252
+#define TEMP_SIZE 32
+#define TEMP_ADDR (FLASH_MEMORY_SIZE - TEMP_SIZE)
+// volatile fields at the start of the temp area, saved in the emergency record
+#ifdef DALI_DT8
+# define EMERGENCY_TEMP_SIZE (sizeof(controller::Memory::Temp) + sizeof(controller::MemoryDT8::TempDT8))
+#else
+# define EMERGENCY_TEMP_SIZE sizeof(controller::Memory::Temp)
+#endif // DALI_DT8
+// pages A and B of the firmware before the flash log (4th and 3rd from the
+// end of the flash) are log pages now
+#define LEGACY_PAGE_A (XMC_DALI_FLASH_LOG_PAGES + 1 - 4)
+#define LEGACY_PAGE_B (XMC_DALI_FLASH_LOG_PAGES + 1 - 3)
+
+uint32_t gMaxIrqBlockedUs = 0;
+
+// pages reserved by the linker script at the end of the flash
+class Flash: public util::IFlash {
 public:
-  FlashMemory(uint32_t* pageAddrA, uint32_t* pageAddrB, size_t words) :
-      mPageAddrA(pageAddrA), mPageAddrB(pageAddrB), mWords(words + 1), mState(State::UINTIALIZED) {
-    mData = new uint32_t[mWords];
+  Flash(uint8_t* base, uint16_t pages) :
+      mBase(base), mPages(pages) {
   }
 
-  ~FlashMemory() {
-    delete mData;
+  uint16_t pageCount() override {
+    return mPages;
   }
 
-  size_t write(uintptr_t addr, const uint8_t* data, size_t size) {
-    if (mState == State::UINTIALIZED) {
-      return 0;
-    }
-    FlashMetaData* metaData = (FlashMetaData*) mData;
-    uint8_t* writeData = (uint8_t*) mData + addr + FLASH_MEMORY_OFFSET;
-    bool changed = false;
-    for (size_t i = 0; i < size; ++i, ++writeData, ++data) {
-      if (*writeData != *data) {
-        changed = true;
-      }
-      // update checksum
-      metaData->crc16 += *writeData;
-      metaData->crc16 -= *data;
-      // store data
-      *writeData = *data;
-    }
-    if (changed) {
-      switch (mState) {
-      case State::SYNCHORONIZED_A:
-      case State::DATA_MODIFIED_A:
-        mState = State::DATA_MODIFIED_A;
-        break;
-
-      case State::SYNCHORONIZED_B:
-      case State::DATA_MODIFIED_B:
-        mState = State::DATA_MODIFIED_B;
-        break;
-
-      default:
-        break;
-      }
-    }
-    return size;
+  uint16_t pageSize() override {
+    return XMC_FLASH_BYTES_PER_PAGE;
   }
 
-  size_t read(uintptr_t addr, uint8_t* data, size_t size) {
-    uint8_t* readData = (uint8_t*) mData + addr + FLASH_MEMORY_OFFSET;
-    memcpy(data, (uint8_t*) readData, size);
-    return size;
+  uint16_t blockSize() override {
+    return XMC_FLASH_WORDS_PER_BLOCK * sizeof(uint32_t);
   }
 
-  const uint8_t* getData(uintptr_t addr) {
-    return (uint8_t*) mData + addr + FLASH_MEMORY_OFFSET;
+  const uint8_t* page(uint16_t page) override {
+    return mBase + page * XMC_FLASH_BYTES_PER_PAGE;
   }
 
-  void erase() {
-    erasePage(mPageAddrA);
-    erasePage(mPageAddrB);
+  bool erase(uint16_t page) override {
+    // any write to the page starts the erase
+    start(0xa2, (uint32_t*) (mBase + page * XMC_FLASH_BYTES_PER_PAGE), nullptr, 1);
+    return true;
   }
 
-  void synchronize(bool emergency) {
-    switch (mState) {
-    case State::SYNCHORONIZED_A:
-    case State::SYNCHORONIZED_B:
-      // do nothing
-      break;
-
-    case State::DATA_MODIFIED_A: {
-      const FlashMetaData* metaDataB = (FlashMetaData*) mPageAddrB;
-      if (metaDataB->metaData == 0xffffffff) { // fast check erased
-        synchronizePages(mPageAddrB, emergency ? nullptr : mPageAddrA);
-        mState = State::SYNCHORONIZED_B;
-      } else {
-        const FlashMetaData* metaDataA = (FlashMetaData*) mPageAddrA;
-        if (metaDataA->metaData == 0xffffffff) { // fast check erased
-          synchronizePages(mPageAddrA, emergency ? nullptr : mPageAddrB);
-          mState = State::SYNCHORONIZED_A;
-        } else {
-          // retry next time
-          erasePage(mPageAddrB);
-        }
-      }
-      break;
-    }
-    case State::DATA_MODIFIED_B: {
-      const FlashMetaData* metaDataA = (FlashMetaData*) mPageAddrA;
-      if (metaDataA->metaData == 0xffffffff) { // fast check erased
-        synchronizePages(mPageAddrA, emergency ? nullptr : mPageAddrB);
-        mState = State::SYNCHORONIZED_A;
-      } else {
-        const FlashMetaData* metaDataB = (FlashMetaData*) mPageAddrB;
-        if (metaDataB->metaData == 0xffffffff) { // fast check erased
-          synchronizePages(mPageAddrB, emergency ? nullptr : mPageAddrA);
-          mState = State::SYNCHORONIZED_B;
-        } else {
-          // retry next time
-          erasePage(mPageAddrA);
-        }
-      }
-      break;
+  bool program(uint16_t page, uint16_t offset, const uint8_t* data, uint16_t size) override {
+    uint32_t* flash = (uint32_t*) (mBase + page * XMC_FLASH_BYTES_PER_PAGE + offset);
+    uint32_t block[XMC_FLASH_WORDS_PER_BLOCK];
+    for (uint16_t j = 0; j < size; j += sizeof(block)) {
+      memcpy(block, data + j, sizeof(block));
+      start(0xa1, flash + j / sizeof(uint32_t), block, XMC_FLASH_WORDS_PER_BLOCK);
     }
-    case State::UINTIALIZED:
-    default: {
-      initialize();
-      break;
-    }
-    } // switch (mState)
+    return memcmp(flash, data, size) == 0;
   }
 
 private:
+  // Interrupts are disabled only while the command is set up. The CPU and the
+  // interrupt handlers stall on flash reads until the operation ends, so the
+  // whole operation is the interrupt latency.
+  void start(uint8_t action, uint32_t* flash, const uint32_t* data, uint16_t words) {
+    Time begin = Timer::getTimeUs();
+    __disable_irq();
 
-  enum class ReadState {
-    INVALID, ERASED, OK
-  };
-
-  enum class State {
-    UINTIALIZED, SYNCHORONIZED_A, SYNCHORONIZED_B, DATA_MODIFIED_A, DATA_MODIFIED_B,
-  };
-
-  typedef union {
-    struct {
-      uint32_t crc16 :16;
-      uint32_t index :16;
-    };
-    uint32_t metaData;
-  } FlashMetaData;
-
-  void writePage(uint32_t* flash) {
-    const size_t blocks = mWords / (XMC_FLASH_WORDS_PER_PAGE / XMC_FLASH_BLOCKS_PER_PAGE);
-    uint32_t* data = mData;
-    FlashMetaData* metaDataA = (FlashMetaData*) data;
-    metaDataA->index--;
-    for (uint16_t j = 0; j < blocks; j++) {
-      __disable_irq();
-
-      NVM->NVMPROG &= (uint16_t) (~(uint16_t) NVM_NVMPROG_ACTION_Msk);
-      NVM->NVMPROG |= (uint16_t) (NVM_NVMPROG_RSTVERR_Msk | NVM_NVMPROG_RSTECC_Msk);
-      NVM->NVMPROG |= (uint16_t) ((uint32_t) 0xa1 << NVM_NVMPROG_ACTION_Pos);
-
-      for (uint16_t i = 0; i < XMC_FLASH_WORDS_PER_BLOCK; ++i, ++data, ++flash) {
-        *flash = *data;
-      }
-
-      while (XMC_FLASH_IsBusy() == true) {
-      }
-
-      NVM->NVMPROG &= (uint16_t) (~(uint16_t) NVM_NVMPROG_ACTION_Msk);
-
-      __enable_irq();
-    }
-  }
-
-  bool verifyPage(uint32_t* flash) {
-    uint32_t* data = mData;
-    for (uint16_t i = 0; i < mWords; ++i, ++data, ++flash) {
-      if (*flash != *data) {
-        return false;
-      }
-    }
-    return true;
-  }
+    NVM->NVMPROG &= (uint16_t) (~(uint16_t) NVM_NVMPROG_ACTION_Msk);
+    NVM->NVMPROG |= (uint16_t) (NVM_NVMPROG_RSTVERR_Msk | NVM_NVMPROG_RSTECC_Msk);
+    NVM->NVMPROG |= (uint16_t) ((uint32_t) action << NVM_NVMPROG_ACTION_Pos);
 
-  ReadState readPage(uint32_t* flash, uint32_t* data) {
-    const FlashMetaData* metaData = (FlashMetaData*) flash;
-    uint16_t crc16 = metaData->crc16;
-    *data++ = *flash++;
-    ReadState state = ReadState::ERASED;
-    for (uint16_t i = 1; i < mWords; ++i, ++data, ++flash) {
-      uint32_t word = *flash;
-      crc16 += (word >> 24) & 0xff;
-      crc16 += (word >> 16) & 0xff;
-      crc16 += (word >> 8) & 0xff;
-      crc16 += (word >> 0) & 0xff;
-      if (word != 0xffffffff) {
-        state = ReadState::INVALID;
-      }
-      *data = word;
+    for (uint16_t i = 0; i < words; ++i) {
+      flash[i] = data != nullptr ? data[i] : 0;
     }
-    if (crc16 == 0) {
-      state = ReadState::OK;
-    }
-    return state;
-  }
 
-  void erasePage(uint32_t* flash) {
-    __disable_irq();
-    XMC_FLASH_ErasePage(flash);
     __enable_irq();
-  }
-
-  void initialize() {
-    uint32_t dataB[mWords];
-
-    ReadState readStateA = readPage(mPageAddrA, mData);
-    ReadState readStateB = readPage(mPageAddrB, dataB);
-
-    switch (readStateA) {
-    case ReadState::ERASED: {
-
-      switch (readStateB) {
-      case ReadState::ERASED:
-        mData[0] = (0 - (0xff * (mWords - 1) * sizeof(uint32_t))) | 0xffff0000;
-        mState = State::SYNCHORONIZED_A;
-        break;
-
-      case ReadState::INVALID:
-        erasePage(mPageAddrB);
-        mData[0] = (0 - (0xff * (mWords - 1) * sizeof(uint32_t))) | 0xffff0000;
-        mState = State::SYNCHORONIZED_B;
-        break;
-
-      case ReadState::OK:
-        memcpy(mData, dataB, mWords * sizeof(uint32_t));
-        mData[0] |= 0xffff0000;
-        mState = State::SYNCHORONIZED_B;
-        break;
-      }
 
-      break;
+    while (XMC_FLASH_IsBusy() == true) {
     }
 
-    case ReadState::OK: {
-
-      switch (readStateB) {
-      case ReadState::ERASED:
-        mData[0] |= 0xffff0000;
-        mState = State::SYNCHORONIZED_A;
-        break;
-
-      case ReadState::INVALID:
-        erasePage(mPageAddrB);
-        mData[0] |= 0xffff0000;
-        mState = State::SYNCHORONIZED_A;
-        break;
-
-      case ReadState::OK: {
-        FlashMetaData* metaDataA = (FlashMetaData*) mData;
-        FlashMetaData* metaDataB = (FlashMetaData*) dataB;
-        if (metaDataA->index < metaDataB->index) {
-          erasePage(mPageAddrB);
-          mState = State::SYNCHORONIZED_A;
-        } else {
-          erasePage(mPageAddrA);
-          memcpy(mData, dataB, mWords * sizeof(uint32_t));
-          mState = State::SYNCHORONIZED_B;
-        }
-
-        break;
-      }
-      }
-
-      break;
+    uint32_t blocked = timeDiff(Timer::getTimeUs(), begin);
+    if (blocked > gMaxIrqBlockedUs) {
+      gMaxIrqBlockedUs = blocked;
     }
 
-    case ReadState::INVALID: {
-      erasePage(mPageAddrA);
+    NVM->NVMPROG &= (uint16_t) (~(uint16_t) NVM_NVMPROG_ACTION_Msk);
+  }
 
-      switch (readStateB) {
-      case ReadState::ERASED:
-        mData[0] = (0 - (0xff * (mWords - 1) * sizeof(uint32_t))) | 0xffff0000;
-        memset(&mData[1], 0xff, mWords * sizeof(uint32_t));
-        mState = State::SYNCHORONIZED_A;
-        break;
+  uint8_t* const mBase;
+  const uint16_t mPages;
+};
 
-      case ReadState::INVALID:
-        erasePage(mPageAddrB);
+static_assert(util::FlashMemory::kEmergencyHeaderSize + EMERGENCY_TEMP_SIZE <= XMC_FLASH_WORDS_PER_BLOCK * sizeof(uint32_t),
+    "emergency record exceeds a block");
 
-        mData[0] = (0 - (0xff * (mWords - 1) * sizeof(uint32_t))) | 0xffff0000;
-        memset(&mData[1], 0xff, mWords * sizeof(uint32_t));
-        mState = State::SYNCHORONIZED_A;
-        break;
+const util::FlashMemory::Config kFlashMemoryConfig = {
+    FLASH_MEMORY_SIZE, TEMP_ADDR, EMERGENCY_TEMP_SIZE, XMC_DALI_EMERGENCY_DATA_CHUNKS,
+    XMC_DALI_MEMORY_QUIET_MS, XMC_DALI_MEMORY_MIN_INTERVAL_MS, LEGACY_PAGE_A, LEGACY_PAGE_B };
 
-      case ReadState::OK:
-        memcpy(mData, dataB, mWords * sizeof(uint32_t));
-        mData[0] |= 0xffff0000;
-        mState = State::SYNCHORONIZED_B;
-        break;
-      }
+// the emergency page follows the log pages at the end of the flash
+#define FLASH_LOG_START (XMC_DALI_FLASH_START + XMC_DALI_FLASH_SIZE - XMC_FLASH_BYTES_PER_PAGE * (XMC_DALI_FLASH_LOG_PAGES + 1))
 
-      break;
-    }
+Flash gFlash((uint8_t*) FLASH_LOG_START, XMC_DALI_FLASH_LOG_PAGES);
+Flash gEmergencyFlash((uint8_t*) (FLASH_LOG_START + XMC_FLASH_BYTES_PER_PAGE * XMC_DALI_FLASH_LOG_PAGES), 1);
+uint8_t gDataShadow[FLASH_MEMORY_SIZE];
+util::FlashMemory gDataMemory(&gFlash, &gEmergencyFlash, gDataShadow, &kFlashMemoryConfig, Timer::getTimeMs);
 
-    } // switch (readStateA)
-  }
-
-  void synchronizePages(uint32_t* writePageAddr, uint32_t* erasePageAddr) {
-    writePage(writePageAddr);
-    if (verifyPage(writePageAddr)) {
-      if (erasePageAddr != nullptr) {
-        erasePage(erasePageAddr);
-      }
-    }
-  }
+// memory bank 5, kept in RAM
+typedef struct __attribute__((__packed__)) {
+  uint8_t size; // BANK mandatory field
+  uint8_t crc;  // BANK mandatory field
+  uint32_t bootToLightUs;
+  uint16_t loadUs; // flash log replay
+} Diagnostics;
 
-  uint32_t* const mPageAddrA;
-  uint32_t* const mPageAddrB;
-  const size_t mWords;
-  uint32_t* mData;
-  State mState;
-};
+static_assert(sizeof(Diagnostics) == DALI_BANK6_ADDR - DALI_BANK5_ADDR, "invalid diagnostic bank size");
 
-#define TEMP_SIZE 32
+Diagnostics gDiagnostics = { sizeof(Diagnostics) - 1, 0, 0, 0 };
 
-FlashMemory gDataMemory((uint32_t*) (XMC_DALI_FLASH_START + XMC_DALI_FLASH_SIZE - XMC_FLASH_BYTES_PER_PAGE * 4),
-                         (uint32_t*) (XMC_DALI_FLASH_START + XMC_DALI_FLASH_SIZE - XMC_FLASH_BYTES_PER_PAGE * 3),
-                         FLASH_MEMORY_SIZE / sizeof(uint32_t));
+void updateDiagnosticsCrc() {
+  const uint8_t* data = (const uint8_t*) &gDiagnostics;
+  uint8_t crc = 0;
+  for (uint8_t i = 2; i < sizeof(Diagnostics); ++i) {
+    crc -= data[i];
+  }
+  gDiagnostics.crc = crc;
+}
 } // namespace
 
 //static
@@ -338,7 +155,10 @@ Memory* Memory::getInstance() {
 
 Memory::Memory(void* handle, size_t dataSize, uintptr_t tempAddr) :
     mHandle(handle), mTempAddr(tempAddr) {
-  ((FlashMemory*) handle)->synchronize(false);
+  Time start = Timer::getTimeUs();
+  ((util::FlashMemory*) handle)->initialize();
+  gDiagnostics.loadUs = timeDiff(Timer::getTimeUs(), start);
+  updateDiagnosticsCrc();
 }
 
 size_t Memory::dataSize() {
@@ -349,14 +169,17 @@ size_t Memory::dataWrite(uintptr_t addr, const uint8_t* data, size_t size) {
   if (addr > FLASH_MEMORY_SIZE || addr + size > FLASH_MEMORY_SIZE) {
     return 0;
   }
-  return ((FlashMemory*) mHandle)->write(addr, data, size);
+  return ((util::FlashMemory*) mHandle)->write(addr, data, size, false);
 }
 
 const uint8_t* Memory::data(uintptr_t addr, size_t size) {
+  if (addr >= DALI_BANK5_ADDR && addr + size <= DALI_BANK6_ADDR) {
+    return (const uint8_t*) &gDiagnostics + addr - DALI_BANK5_ADDR;
+  }
   if (addr > FLASH_MEMORY_SIZE || addr + size > FLASH_MEMORY_SIZE) {
     return nullptr;
   }
-  return ((FlashMemory*) mHandle)->getData(addr);
+  return ((util::FlashMemory*) mHandle)->getData(addr);
 }
 
 size_t Memory::tempSize() {
@@ -367,19 +190,35 @@ size_t Memory::tempWrite(uintptr_t addr, const uint8_t* data, size_t size) {
   if (addr > TEMP_SIZE || addr + size > TEMP_SIZE) {
     return 0;
   }
-  return ((FlashMemory*) mHandle)->write(mTempAddr + addr, data, size);
+  return ((util::FlashMemory*) mHandle)->write(mTempAddr + addr, data, size, true);
 }
 
 const uint8_t* Memory::tempData(uintptr_t addr, size_t size) {
   if (addr > TEMP_SIZE || addr + size > TEMP_SIZE) {
     return nullptr;
   }
-  return ((FlashMemory*) mHandle)->getData(mTempAddr + addr);
+  return ((util::FlashMemory*) mHandle)->getData(mTempAddr + addr);
+}
+
+//static
+void Memory::synchronize() {
+  gDataMemory.synchronize();
+}
+
+//static
+void Memory::runSlice() {
+  gDataMemory.runSlice();
+}
+
+//static
+void Memory::setBootToLightUs(uint32_t time) {
+  gDiagnostics.bootToLightUs = time;
+  updateDiagnosticsCrc();
 }
 
 //static
-void Memory::synchronize(bool emergency) {
-  gDataMemory.synchronize(emergency);
+uint32_t Memory::getMaxIrqBlockedUs() {
+  return gMaxIrqBlockedUs;
 }
 
 //static
@@ -19,7 +19,7 @@
 namespace dali {
 namespace xmc {
 
-class Memory: public dali::IMemory {
+class Memory final: public dali::IMemory {
 public:
   static Memory* getInstance();
 
@@ -31,9 +31,18 @@ public:
   size_t tempWrite(uintptr_t addr, const uint8_t* data, size_t size) override;
   const uint8_t* tempData(uintptr_t addr, size_t size) override;
 
-  static void synchronize(bool temp);
+  // called on brown-out, stores the volatile fields and at most
+  // XMC_DALI_EMERGENCY_DATA_CHUNKS changed data chunks
+  static void synchronize();
   static void erase(bool temp);
 
+  // does one step of the flash work, call only when the bus is idle
+  static void runSlice();
+  // longest flash operation, the interrupt handlers are blocked during it
+  static uint32_t getMaxIrqBlockedUs();
+  // time from the timer start to the power on level, shown in the diagnostic bank
+  static void setBootToLightUs(uint32_t time);
+
 private:
   Memory(void* handle, size_t dataSize, uintptr_t tempAddr);
   Memory(const Memory& other) = delete;
@@ -13,5 +13,15 @@
 
 # define XMC_DALI_FLASH_START 0x10001000
 # define XMC_DALI_FLASH_SIZE 0x32000
+// pages at the end of the flash reserved by the linker script: the log pages
+// and one page for the emergency records
+# define XMC_DALI_FLASH_LOG_PAGES 5
+// background synchronization after the data was not changed for the quiet
+// period, but not more often than the minimum interval
+# define XMC_DALI_MEMORY_QUIET_MS 2000
+# define XMC_DALI_MEMORY_MIN_INTERVAL_MS 10000
+// changed data chunks stored on brown-out after the emergency record, more
+// changes are stored in the background at once
+# define XMC_DALI_EMERGENCY_DATA_CHUNKS 2
 
 #endif // XMC_DALI_MEMORY_CONFIG_H_
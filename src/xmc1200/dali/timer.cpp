@@ -10,8 +10,13 @@
 
 #include "timer.hpp"
 
+#include "events.hpp"
+
+#include <xmc_ccu4.h>
 #include <xmc_prng.h>
 
+#include <string.h>
+
 namespace dali {
 namespace xmc {
 
@@ -19,17 +24,24 @@ namespace {
 
 const uint16_t* kUniqeChipId = (uint16_t*) 0x10000FF0; // 8 elements
 
-#define MAX_TASKS (3)
-#define TICKS_PER_SECOND 1000
-
-typedef struct {
-  dali::ITimer::ITimerTask* task;
-  Time time;
-  uint32_t period;
-} TaskInfo;
-
-TaskInfo gTasks[MAX_TASKS];
-volatile Time gSystemTimeMs;
+// Free running microsecond counter, extended on each wrap, and a single
+// shot alarm for the next deadline. Both slices use the service request 0
+// of the bus TX slice.
+#define TIMER_COUNTER_SLICE CCU40_CC40
+#define TIMER_COUNTER_SLICE_NUMBER 0
+#define TIMER_COUNTER_SLICE_SHADOW_TRANSFER XMC_CCU4_SHADOW_TRANSFER_SLICE_0
+#define TIMER_ALARM_SLICE CCU40_CC41
+#define TIMER_ALARM_SLICE_NUMBER 1
+#define TIMER_ALARM_SLICE_SHADOW_TRANSFER XMC_CCU4_SHADOW_TRANSFER_SLICE_1
+#define TIMER_PERIOD_US 0x10000UL
+
+util::DeadlineQueue gTasks;
+// time of the last counter wrap, a single 32-bit word updated by the interrupt
+volatile Time gEpochMs;
+volatile uint16_t gEpochUs; // below 1ms
+uint16_t gWakeups;
+uint16_t gWakeupsPerSecond;
+Time gWakeupsTimeMs;
 
 }
 
@@ -49,71 +61,149 @@ Timer::Timer() {
   prngConfig.block_size = XMC_PRNG_RDBS_WORD;
   XMC_PRNG_Init(&prngConfig);
 
-  SysTick_Config(SystemCoreClock / TICKS_PER_SECOND);
+  // the CCU40 module is started here, before the bus uses its other slices
+  XMC_CCU4_Init(CCU40, XMC_CCU4_SLICE_MCMS_ACTION_TRANSFER_PR_CR);
+  XMC_CCU4_StartPrescaler(CCU40);
+  XMC_CCU4_SetModuleClock(CCU40, XMC_CCU4_CLOCK_SCU);
+
+  XMC_CCU4_SLICE_COMPARE_CONFIG_t config;
+  memset(&config, 0, sizeof(config));
+  config.timer_mode = XMC_CCU4_SLICE_TIMER_COUNT_MODE_EA;
+  config.monoshot = XMC_CCU4_SLICE_TIMER_REPEAT_MODE_REPEAT;
+  config.prescaler_mode = XMC_CCU4_SLICE_PRESCALER_MODE_NORMAL;
+  config.prescaler_initval = XMC_CCU4_SLICE_PRESCALER_32; // 1us
+  XMC_CCU4_SLICE_CompareInit(TIMER_COUNTER_SLICE, &config);
+  config.monoshot = XMC_CCU4_SLICE_TIMER_REPEAT_MODE_SINGLE;
+  XMC_CCU4_SLICE_CompareInit(TIMER_ALARM_SLICE, &config);
+
+  XMC_CCU4_SLICE_SetTimerPeriodMatch(TIMER_COUNTER_SLICE, TIMER_PERIOD_US - 1);
+  XMC_CCU4_EnableShadowTransfer(CCU40, TIMER_COUNTER_SLICE_SHADOW_TRANSFER);
+
+  XMC_CCU4_SLICE_EnableEvent(TIMER_COUNTER_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+  XMC_CCU4_SLICE_EnableEvent(TIMER_ALARM_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+  XMC_CCU4_SLICE_SetInterruptNode(TIMER_COUNTER_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH, XMC_CCU4_SLICE_SR_ID_0);
+  XMC_CCU4_SLICE_SetInterruptNode(TIMER_ALARM_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH, XMC_CCU4_SLICE_SR_ID_0);
+  NVIC_SetPriority(CCU40_0_IRQn, 2);
+  NVIC_EnableIRQ(CCU40_0_IRQn);
+
+  XMC_CCU4_EnableClock(CCU40, TIMER_COUNTER_SLICE_NUMBER);
+  XMC_CCU4_EnableClock(CCU40, TIMER_ALARM_SLICE_NUMBER);
+  XMC_CCU4_SLICE_StartTimer(TIMER_COUNTER_SLICE);
 }
 
 Timer::~Timer() {
-  WR_REG(SysTick->CTRL, SysTick_CTRL_ENABLE_Msk, SysTick_CTRL_ENABLE_Pos, 0);
+  XMC_CCU4_SLICE_StopTimer(TIMER_ALARM_SLICE);
+  XMC_CCU4_SLICE_StopTimer(TIMER_COUNTER_SLICE);
 
   XMC_PRNG_DeInit();
 }
 
 dali::Status Timer::schedule(ITimerTask* task, uint32_t delay, uint32_t period) {
-  for (uint8_t i = 0; i < MAX_TASKS; ++i) {
-    TaskInfo* taskInfo = &gTasks[i];
-    if (taskInfo->task == nullptr) {
-      taskInfo->task = task;
-      taskInfo->time = gSystemTimeMs + delay;
-      taskInfo->period = period;
-      return dali::Status::OK;
-    }
-  }
-  return dali::Status::ERROR;
+  gTasks.insert(task, getTimeMs() + delay, period);
+  return dali::Status::OK;
 }
 
 void Timer::cancel(ITimerTask* task) {
-  for (uint8_t i = 0; i < MAX_TASKS; ++i) {
-    TaskInfo* taskInfo = &gTasks[i];
-    if (taskInfo->task == task) {
-      taskInfo->task = nullptr;
-    }
-  }
+  gTasks.remove(task);
 }
 
 uint32_t Timer::randomize() {
-  return ((uint32_t) XMC_PRNG_GetPseudoRandomNumber() << 8) + (uint32_t) gSystemTimeMs;
+  return ((uint32_t) XMC_PRNG_GetPseudoRandomNumber() << 8) + (uint32_t) getTimeUs();
 }
 
 // static
 Time Timer::getTimeMs() {
-  return gSystemTimeMs;
+  Time epochMs;
+  uint32_t us = readCounter(&epochMs);
+  return epochMs + us / 1000;
 }
 
 // static
-void Timer::runSlice() {
-  for (uint8_t i = 0; i < MAX_TASKS; ++i) {
-    TaskInfo* taskInfo = &gTasks[i];
-
-    if (taskInfo->task != nullptr) {
-      if (taskInfo->time <= gSystemTimeMs) {
-        taskInfo->task->timerTaskRun();
-        if (taskInfo->period != 0) {
-          taskInfo->time += taskInfo->period;
-        } else {
-          taskInfo->task = nullptr;
-        }
-      }
+Time Timer::getTimeUs() {
+  Time epochMs;
+  uint32_t us = readCounter(&epochMs);
+  return epochMs * 1000 + us;
+}
+
+// static
+uint32_t Timer::readCounter(Time* epochMs) {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  *epochMs = gEpochMs;
+  uint32_t us = gEpochUs;
+  uint32_t counter = XMC_CCU4_SLICE_GetTimerValue(TIMER_COUNTER_SLICE);
+  if (XMC_CCU4_SLICE_GetEvent(TIMER_COUNTER_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH)) {
+    // the counter wrapped, but the epoch is not updated yet
+    counter = XMC_CCU4_SLICE_GetTimerValue(TIMER_COUNTER_SLICE);
+    if (counter < TIMER_PERIOD_US / 2) {
+      counter += TIMER_PERIOD_US;
     }
   }
+  __set_PRIMASK(primask);
+  return us + counter;
+}
+
+// static
+void Timer::runSlice() {
+  Time now = getTimeMs();
+  util::DeadlineQueue::Entry* task;
+  while ((task = gTasks.popDue(now)) != nullptr) {
+    static_cast<ITimerTask*>(task)->timerTaskRun();
+  }
 }
 
-extern "C" {
+// static
+void Timer::sleep() {
+  Time epochMs;
+  uint32_t us = readCounter(&epochMs);
+  Time now = epochMs + us / 1000;
+  if (!gTasks.isEmpty()) {
+    Time deadline = gTasks.front()->getDeadline();
+    if (!isTimeBefore(now, deadline)) {
+      Events::post(Event::TIMER);
+      return;
+    }
+    // the counter wraps before a longer delay
+    if (timeDiff(deadline, now) < TIMER_PERIOD_US / 1000) {
+      uint32_t delay = timeDiff(deadline, epochMs) * 1000 - us;
+      XMC_CCU4_SLICE_StopTimer(TIMER_ALARM_SLICE);
+      XMC_CCU4_SLICE_SetTimerPeriodMatch(TIMER_ALARM_SLICE, (uint16_t) delay - 1);
+      XMC_CCU4_EnableShadowTransfer(CCU40, TIMER_ALARM_SLICE_SHADOW_TRANSFER);
+      XMC_CCU4_SLICE_ClearTimer(TIMER_ALARM_SLICE);
+      XMC_CCU4_SLICE_StartTimer(TIMER_ALARM_SLICE);
+    }
+  }
+
+  // any interrupt taken since the last sleep sets the event, an event posted
+  // after the queue was drained is not left waiting
+  __WFE();
 
-void SysTick_Handler(void) {
-  gSystemTimeMs += (uint32_t)1000 / TICKS_PER_SECOND;
+  gWakeups++;
+  if (timeDiff(now, gWakeupsTimeMs) >= 1000) {
+    gWakeupsPerSecond = gWakeups;
+    gWakeups = 0;
+    gWakeupsTimeMs = now;
+  }
 }
 
-} // extern "C"
+// static
+uint16_t Timer::getWakeupsPerSecond() {
+  return gWakeupsPerSecond;
+}
+
+// static
+void Timer::onInterrupt() {
+  if (XMC_CCU4_SLICE_GetEvent(TIMER_COUNTER_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH)) {
+    XMC_CCU4_SLICE_ClearEvent(TIMER_COUNTER_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+    uint32_t us = gEpochUs + TIMER_PERIOD_US;
+    gEpochMs += us / 1000;
+    gEpochUs = us % 1000;
+  }
+  if (XMC_CCU4_SLICE_GetEvent(TIMER_ALARM_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH)) {
+    XMC_CCU4_SLICE_ClearEvent(TIMER_ALARM_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+    Events::post(Event::TIMER);
+  }
+}
 
 } // namespace xmc
 } // namespace dali
@@ -16,7 +16,7 @@
 namespace dali {
 namespace xmc {
 
-class Timer: public dali::ITimer {
+class Timer final: public dali::ITimer {
 public:
   static Timer* getInstance();
 
@@ -28,14 +28,27 @@ public:
   uint32_t randomize() override;
 
   static Time getTimeMs();
+  // microseconds, can be called from interrupts
+  static Time getTimeUs();
   static void runSlice();
 
+  // Sleeps until an interrupt, at the latest until the next task is due and
+  // posts Event::TIMER
+  static void sleep();
+  // core wake-ups during the last second
+  static uint16_t getWakeupsPerSecond();
+  // counter and alarm events, called by the CCU40 service request 0 handler
+  static void onInterrupt();
+
 private:
   Timer();
   Timer(const Timer& other) = delete;
   Timer& operator=(const Timer&) = delete;
 
   ~Timer();
+
+  // microseconds since the returned epoch
+  static uint32_t readCounter(Time* epochMs);
 };
 
 } // namespace xmc
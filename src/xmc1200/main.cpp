@@ -18,6 +18,7 @@
 
 #include <xmc1200/clock.hpp>
 #include <xmc1200/dali/bus.hpp>
+#include <xmc1200/dali/events.hpp>
 #include <xmc1200/dali/lamp.hpp>
 #include <xmc1200/dali/memory.hpp>
 #include <xmc1200/dali/timer.hpp>
@@ -37,12 +38,25 @@ void daliTests() {
 }
 #endif // DALI_TEST
 
-dali::Slave* gSlave;
+#ifdef DALI_BENCHMARK
+
+#include <test/benchmarks.hpp>
 
-void waitForInterrupt() {
-  __WFI();
+uint32_t benchmarkCycles() {
+  return SysTick_LOAD_RELOAD_Msk - SysTick->VAL; // SysTick counts down
 }
 
+void daliBenchmarks() {
+  SysTick->LOAD = SysTick_LOAD_RELOAD_Msk;
+  SysTick->VAL = 0;
+  SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+  dali::benchmarks(benchmarkCycles, SysTick_LOAD_RELOAD_Msk);
+  SysTick->CTRL = 0;
+}
+#endif // DALI_BENCHMARK
+
+dali::Slave* gSlave;
+
 void initPowerDetector() {
   XMC_SCU_SUPPLYMONITOR_t config;
   config.ext_supply_threshold = 0b10;
@@ -58,11 +72,12 @@ void initPowerDetector() {
 
 void onPowerUp() {
   gSlave->notifyPowerUp();
+  dali::xmc::Memory::setBootToLightUs(dali::xmc::Timer::getTimeUs());
 }
 
 void onPowerDown() {
   gSlave->notifyPowerDown();
-  dali::xmc::Memory::synchronize(true);
+  dali::xmc::Memory::synchronize();
 }
 
 class PowerOnTimerTask: public dali::ITimer::ITimerTask {
@@ -75,8 +90,6 @@ public:
 
 PowerOnTimerTask gPowerOnTimerTask;
 
-volatile bool gEmergencyMemorySynchronise;
-
 int main(void) {
   xmc::Clock::init(XMC_CPU_FREQ);
 
@@ -84,6 +97,10 @@ int main(void) {
   daliTests();
 #endif
 
+#ifdef DALI_BENCHMARK
+  daliBenchmarks();
+#endif
+
   initPowerDetector();
 
   dali::xmc::Timer* daliTimer = dali::xmc::Timer::getInstance();
@@ -91,7 +108,8 @@ int main(void) {
 
   dali::xmc::Memory* daliMemory1 = dali::xmc::Memory::getInstance();
   dali::xmc::LampRGB* daliLamp1 = dali::xmc::LampRGB::getInstance();
-  gSlave = dali::SlaveDT8::create(daliBus, daliTimer, daliMemory1, daliLamp1);
+  static dali::SlaveStorage<dali::SlaveDT8Config> gSlaveStorage(daliBus, daliTimer, daliMemory1, daliLamp1);
+  gSlave = &gSlaveStorage;
 
   daliTimer->schedule(&gPowerOnTimerTask, 600, 0);
 
@@ -99,13 +117,31 @@ int main(void) {
   XMC_GPIO_SetOutputHigh(XMC_GPIO_PORT0, 0);
 
   while (true) {
-    waitForInterrupt(); // Interrupts are triggered by SysTick 1kHz and from CCU4 (DALI RX) up to 2,4Khz
-    if (gEmergencyMemorySynchronise) {
-      gEmergencyMemorySynchronise = false;
-      onPowerDown();
+    // one event at a time, a more urgent one posted meanwhile goes next
+    dali::xmc::Event event;
+    while (dali::xmc::Events::take(&event)) {
+      switch (event) {
+      case dali::xmc::Event::POWER_DOWN:
+        onPowerDown();
+        break;
+      case dali::xmc::Event::FRAME:
+        dali::xmc::Bus::runFrame();
+        break;
+      case dali::xmc::Event::BUS_STATE:
+        dali::xmc::Bus::runState();
+        break;
+      case dali::xmc::Event::TIMER:
+        dali::xmc::Timer::runSlice();
+        break;
+      default:
+        break;
+      }
+    }
+    if (dali::xmc::Bus::isIdle()) {
+      dali::xmc::Memory::runSlice(); // CPU stalls while the flash is busy
     }
-    dali::xmc::Timer::runSlice();
-    dali::xmc::Bus::runSlice();
+    // woken by the next deadline, the counter wrap (65ms), CCU4 (DALI RX up to 2,4kHz) or the power detector
+    dali::xmc::Timer::sleep();
   }
   return 0;
 }
@@ -119,7 +155,7 @@ void HardFault_Handler(void) {
 void SCU_1_IRQHandler(void) {
   if (SCU_INTERRUPT->SRRAW & SCU_INTERRUPT_SRRAW_VDDPI_Msk) {
     SCU_INTERRUPT->SRCLR = SCU_INTERRUPT_SRCLR_VDDPI_Msk;
-    gEmergencyMemorySynchronise = true;
+    dali::xmc::Events::post(dali::xmc::Event::POWER_DOWN);
   }
 }
 